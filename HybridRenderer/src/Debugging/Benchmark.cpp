@@ -0,0 +1,188 @@
+#include "pch.h"
+#include "Debugging/Benchmark.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iomanip>
+
+#include "Debugging/Logger.hpp"
+#include "Helpers/JobSystem.hpp"
+#include "Helpers/magic_enum.hpp"
+#include "Rendering/Camera.hpp"
+#include "Rendering/HeadlessRenderer.hpp"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    float GetMilliseconds(const Clock::time_point start)
+    {
+        return std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+    }
+
+    //FNV-1a over whole texels instead of bytes, only ever compared against itself
+    constexpr uint64_t HashOffset = 14695981039346656037ull;
+    constexpr uint64_t HashPrime = 1099511628211ull;
+
+    //Nearest rank percentile, the samples have to be sorted
+    float GetPercentile(const std::vector<float>& sortedSamples, const float percentile)
+    {
+        const auto rank = static_cast<size_t>(std::ceil(percentile / 100.f * static_cast<float>(sortedSamples.size())));
+        return sortedSamples[std::clamp(rank, size_t{1}, sortedSamples.size()) - 1];
+    }
+
+    void WriteSummary(std::ostream& stream, std::vector<float> samples)
+    {
+        std::sort(samples.begin(), samples.end());
+        auto total = 0.0;
+        for (const auto sample : samples)
+        {
+            total += sample;
+        }
+
+        stream << "{\"mean\": " << total / static_cast<double>(samples.size())
+               << ", \"p50\": " << GetPercentile(samples, 50.f)
+               << ", \"p95\": " << GetPercentile(samples, 95.f)
+               << ", \"p99\": " << GetPercentile(samples, 99.f)
+               << ", \"min\": " << samples.front()
+               << ", \"max\": " << samples.back() << "}";
+    }
+}
+
+Benchmark::Benchmark(BenchmarkSettings settings)
+    : m_Settings(std::move(settings)),
+      m_Width(0),
+      m_Height(0),
+      m_FramesHash(HashOffset)
+{
+}
+
+#pragma region Workers
+bool Benchmark::Run(HeadlessRenderer& renderer)
+{
+    if (m_Settings.frameCount == 0 || !m_Path.Load(m_Settings.pathName))
+        return false;
+
+    auto* pSceneGraph = SceneGraph::GetInstance();
+    auto* pCamera = pSceneGraph->GetCamera();
+    m_Width = renderer.GetFrame().width;
+    m_Height = renderer.GetFrame().height;
+    LOG(LEVEL_INFO, "Benchmarking " << m_Settings.sceneName << " along " << m_Settings.pathName << ", " << m_Settings.frameCount << " frames of " << m_Width << "x" << m_Height)
+    Logger::GetInstance()->OutputLog();
+
+    // Warming up doesn't advance time, the measured frames start from the same scene state no matter how many there were
+    for (uint32_t frameIdx = 0; frameIdx < m_Settings.warmupFrameCount; ++frameIdx)
+    {
+        ApplyPose(0.f);
+        pCamera->Update(0.f);
+        pSceneGraph->Update(0.f);
+        renderer.Render();
+        Logger::GetInstance()->OutputLog();
+    }
+
+    m_Samples.clear();
+    m_Samples.reserve(m_Settings.frameCount);
+    m_FramesHash = HashOffset;
+    for (uint32_t frameIdx = 0; frameIdx < m_Settings.frameCount; ++frameIdx)
+    {
+        // Time comes from the frame index, never from the clock
+        const auto frameStart = Clock::now();
+        ApplyPose(static_cast<float>(frameIdx) * m_Settings.dT);
+        pCamera->Update(m_Settings.dT);
+        pSceneGraph->Update(m_Settings.dT);
+        const auto updateMs = GetMilliseconds(frameStart);
+        renderer.Render();
+        m_Samples.push_back({GetMilliseconds(frameStart), updateMs, pSceneGraph->GetSoftwareStageTimes()});
+        Logger::GetInstance()->OutputLog();
+
+        for (const auto texel : renderer.GetFrame().texels)
+        {
+            m_FramesHash = (m_FramesHash ^ texel) * HashPrime;
+        }
+
+        if (!m_Settings.frameDirectory.empty())
+        {
+            char fileName[32];
+            std::snprintf(fileName, sizeof(fileName), "/frame_%04u.png", frameIdx);
+            if (!renderer.SaveFrame(m_Settings.frameDirectory + fileName))
+                return false;
+        }
+    }
+    return true;
+}
+
+void Benchmark::ApplyPose(const float time) const
+{
+    const auto pose = m_Path.GetPose(time);
+    SceneGraph::GetInstance()->GetCamera()->SetPose(pose.position, pose.pitch, pose.yaw);
+    SceneGraph::GetInstance()->SetObjectsRotating(pose.areObjectsRotating);
+}
+
+void Benchmark::WriteJSON(std::ostream& stream) const
+{
+    if (m_Samples.empty())
+        return;
+
+    const auto* pSceneGraph = SceneGraph::GetInstance();
+#if defined(__AVX2__)
+    const auto isAVX2 = true;
+#else
+    const auto isAVX2 = false;
+#endif
+
+    stream << std::fixed << std::setprecision(4);
+    stream << "{\n";
+    stream << "  \"scene\": \"" << m_Settings.sceneName << "\",\n";
+    stream << "  \"path\": \"" << m_Settings.pathName << "\",\n";
+    stream << "  \"renderer\": \"software\",\n";
+    stream << "  \"width\": " << m_Width << ",\n";
+    stream << "  \"height\": " << m_Height << ",\n";
+    stream << "  \"frames\": " << m_Samples.size() << ",\n";
+    stream << "  \"warmupFrames\": " << m_Settings.warmupFrameCount << ",\n";
+    stream << "  \"dT\": " << m_Settings.dT << ",\n";
+    stream << "  \"threads\": " << JobSystem::GetInstance()->GetThreadCount() << ",\n";
+    stream << "  \"tileSize\": " << pSceneGraph->GetSoftwareTileSize() << ",\n";
+    stream << "  \"shadingMode\": \"" << magic_enum::enum_name(pSceneGraph->GetSoftwareShadingMode()) << "\",\n";
+    stream << "  \"antiAliasing\": \"" << magic_enum::enum_name(pSceneGraph->GetSoftwareAntiAliasing()) << "\",\n";
+    stream << "  \"avx2\": " << (isAVX2 ? "true" : "false") << ",\n";
+    stream << "  \"framesHash\": \"" << std::hex << std::setw(16) << std::setfill('0') << m_FramesHash << std::dec << std::setfill(' ') << "\",\n";
+
+    const auto collect = [this](float (*pGetSample)(const FrameSample&))
+    {
+        std::vector<float> samples;
+        samples.reserve(m_Samples.size());
+        for (const auto& sample : m_Samples)
+        {
+            samples.push_back(pGetSample(sample));
+        }
+        return samples;
+    };
+
+    stream << "  \"frameMs\": ";
+    WriteSummary(stream, collect([](const FrameSample& sample) { return sample.frame; }));
+    stream << ",\n";
+
+    // Stages in the order a frame runs them
+    using StageGetter = float (*)(const FrameSample&);
+    const std::pair<const char*, StageGetter> stages[]
+    {
+        {"update", [](const FrameSample& sample) { return sample.update; }},
+        {"clear", [](const FrameSample& sample) { return sample.stages.clear; }},
+        {"updateWait", [](const FrameSample& sample) { return sample.stages.updateWait; }},
+        {"transformBin", [](const FrameSample& sample) { return sample.stages.transformBin; }},
+        {"rasterize", [](const FrameSample& sample) { return sample.stages.rasterize; }},
+        {"resolve", [](const FrameSample& sample) { return sample.stages.resolve; }},
+        {"blend", [](const FrameSample& sample) { return sample.stages.blend; }}
+    };
+    stream << "  \"stageMs\": {\n";
+    for (size_t stageIdx = 0; stageIdx < std::size(stages); ++stageIdx)
+    {
+        stream << "    \"" << stages[stageIdx].first << "\": ";
+        WriteSummary(stream, collect(stages[stageIdx].second));
+        stream << (stageIdx + 1 < std::size(stages) ? ",\n" : "\n");
+    }
+    stream << "  }\n";
+    stream << "}\n";
+}
+#pragma endregion
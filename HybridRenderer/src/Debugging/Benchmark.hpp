@@ -0,0 +1,61 @@
+#ifndef BENCHMARK_HPP
+#define BENCHMARK_HPP
+
+//Standard includes
+#include <ostream>
+#include <string>
+#include <vector>
+
+//Project includes
+#include "Scene/CameraPath.hpp"
+#include "Scene/SceneGraph.hpp"
+
+class HeadlessRenderer;
+
+struct BenchmarkSettings
+{
+    std::string sceneName{"vehicle"};
+    std::string pathName{"orbit"};
+    uint32_t frameCount = 300;
+    uint32_t warmupFrameCount = 10; // rendered at the start pose before measuring, they fill the caches and the frame arena
+    float dT = 1.f / 60.f;
+    std::string frameDirectory;     // every measured frame is written there as a PNG, nothing is written when empty
+};
+
+//Plays a camera path through Camera and SceneGraph::Update with a fixed time step and measures every frame.
+//Everything but the time a frame takes is fixed, so two runs render the same images and only the timings can differ.
+//The hash of all measured frames tells whether two builds really rendered the same thing.
+class Benchmark final
+{
+public:
+    explicit Benchmark(BenchmarkSettings settings);
+    ~Benchmark() = default;
+
+    DEL_ROF(Benchmark)
+
+    //Workers
+    //The renderer has to have loaded settings.sceneName already
+    [[nodiscard]] bool Run(HeadlessRenderer& renderer);
+    //Settings, frame time percentiles and per stage breakdown of the last run
+    void WriteJSON(std::ostream& stream) const;
+
+private:
+    //Timings of a single measured frame, in milliseconds
+    struct FrameSample
+    {
+        float frame;
+        float update; // camera and scheduling the mesh updates, the updates themselves are part of the stage times
+        SoftwareStageTimes stages;
+    };
+
+    BenchmarkSettings m_Settings;
+    CameraPath m_Path;
+    uint32_t m_Width;
+    uint32_t m_Height;
+    std::vector<FrameSample> m_Samples;
+    uint64_t m_FramesHash;
+
+    void ApplyPose(float time) const;
+};
+
+#endif // !BENCHMARK_HPP
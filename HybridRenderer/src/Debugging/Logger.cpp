@@ -3,8 +3,21 @@
 #include "Helpers/GeneralHelpers.hpp"
 #include "Helpers/magic_enum.hpp"
 
+#ifdef HYBRID_HEADLESS
+// stderr, stdout belongs to whatever the headless build writes there, like benchmark results
 void Logger::OutputLog() noexcept
 {
+    std::lock_guard lock(m_Mutex);
+    for (const auto& log : m_LogList)
+    {
+        std::cerr << RawOutput(log.level, log.header) << log.message.str() << "\n";
+    }
+    m_LogList.clear();
+}
+#else
+void Logger::OutputLog() noexcept
+{
+    std::lock_guard lock(m_Mutex);
     m_LogList.remove_if([](const LogEntry& entry) { return entry.markedForClear; });
     //m_LogList.erase(std::remove_if(m_LogList.begin(), m_LogList.end(), [](const LogEntry& entry) { return entry.markedForClear; }), m_LogList.end());
 
@@ -45,3 +58,4 @@ void Logger::OutputLog() noexcept
     }
     ImGui::End();
 }
+#endif
@@ -4,6 +4,7 @@
 // General Includes
 #include <list>
 #include <array>
+#include <mutex>
 #include <sstream>
 
 // Project Includes
@@ -62,6 +63,31 @@ struct LogEntry
 	{}
 };
 
+//Entry being written by a LOG statement, holding the log's lock until the statement ends lets several threads log at once
+class LogLine final
+{
+public:
+	LogLine(std::unique_lock<std::mutex>&& lock, LogEntry& entry)
+		: m_Lock(std::move(lock))
+		, m_Entry(entry)
+	{}
+
+	/**
+	 * Ostream for extra log messages
+	 * @param log Log message
+	 * */
+	template<class T>
+	LogLine& operator<<(const T& log)
+	{
+		m_Entry.message << log;
+		return *this;
+	}
+
+private:
+	std::unique_lock<std::mutex> m_Lock;
+	LogEntry& m_Entry;
+};
+
 class Logger final : public Singleton<Logger>
 {
 public:
@@ -69,28 +95,20 @@ public:
 	explicit Logger(Token) {}
 	
 	/**
-	 * Log Function 
+	 * Log Function, safe to call from any thread
 	 * @template Level LogLevel
 	 * @param header Name of the scope this log was called in
+	 * @returns the new entry, the log stays locked until the LOG statement ends
 	 * */
 	template<LogLevel Level>
-	static Logger& Log(const std::string& header = "")
+	static LogLine Log(const std::string& header = "")
 	{
 		static_assert(Level != LogLevel::LEVEL_FULL, "LEVEL_FULL is not a valid LogLevel");
 
-		GetInstance()->m_LogList.emplace_back(LogEntry(header, Level));
-		return *GetInstance();
-	}
-
-	/**
-	 * Ostream for extra log messages
-	 * @param log Log message
-	 * */
-	template<class T>
-	Logger& operator<<(const T& log)
-	{
-		m_LogList.back().message << log;
-		return *GetInstance();
+		auto* pLogger = GetInstance();
+		std::unique_lock lock(pLogger->m_Mutex);
+		pLogger->m_LogList.emplace_back(LogEntry(header, Level));
+		return LogLine(std::move(lock), pLogger->m_LogList.back());
 	}
 
 	/**
@@ -99,19 +117,23 @@ public:
 	 * */
 	std::string RawOutput(const LogLevel level, const std::string& header) const 
 	{
-		return std::string("[" + std::string(magic_enum::enum_name(level)) + "] " + header + " > ");
+		std::string output{"["};
+		output.append(magic_enum::enum_name(level)).append("] ").append(header).append(" > ");
+		return output;
 	}
 
 	/**
-	 * ImGui code to output the logger window
+	 * ImGui code to output the logger window, headless builds print the new entries to the console instead
 	 * */
 	void OutputLog() noexcept;
 
 private:
 	
+	std::mutex m_Mutex;
 	std::list<LogEntry> m_LogList;
 	bool m_ShowHeaders = true;
 	LogLevel m_CurrentLevel = LogLevel::LEVEL_FULL;
+#ifndef HYBRID_HEADLESS
 
 	const std::array<ImVec4, 6> m_ImGuiColors
 	{
@@ -122,6 +144,7 @@ private:
 		ImVec4{ 1.f, 0.f, 0.f, 1.f },	// ERROR
 		ImVec4{ 1.f, 1.f, 1.f, 1.f }	// DEFAULT
 	};
+#endif
 };
 
 #endif // !LOGGER_HPP
\ No newline at end of file
@@ -1,21 +1,30 @@
 #include "pch.h"
 #include "Geometry/Mesh.hpp"
 
+#include <bit>
+
 #include <glm/gtc/constants.hpp>
 #include <glm/gtx/transform.hpp>
 #include <glm/gtx/euler_angles.hpp>
 
 #include "Helpers/GeneralHelpers.hpp"
 #include "Helpers/GeometryHelpers.hpp"
+#include "Helpers/SIMDHelpers.hpp"
 #include "Materials/Material.hpp"
+#include "Materials/MaterialFlat.hpp"
 #include "Materials/MaterialManager.hpp"
+#include "Materials/MaterialMapped.hpp"
 #include "Scene/SceneGraph.hpp"
 #include "Rendering/Camera.hpp"
+#include "Rendering/TileBinner.hpp"
+#include "Rendering/TriangleSetup.hpp"
 
 
-Mesh::Mesh(ID3D11Device* pDevice, const std::string& modelPath, Material* pMaterial, const glm::vec3& origin)
-    : m_MaterialName(pMaterial->GetName()),
+Mesh::Mesh(ID3D11Device* pDevice, const std::string& modelPath, const MaterialHandle material, const glm::vec3& origin)
+    : m_MaterialHandle(material),
+      m_WorldMatrix(glm::translate(origin)),
       m_Origin(origin),
+      m_RotationAngle(0.f),
       m_Topology(PrimitiveTopology::TriangleList) //Triangle strip is implemented, but can not be used currently
 {
     MeshParser parser{};
@@ -26,12 +35,9 @@ Mesh::Mesh(ID3D11Device* pDevice, const std::string& modelPath, Material* pMater
 
 Mesh::~Mesh()
 {
-    if (m_pIndexBuffer)
-        m_pIndexBuffer->Release();
-    if (m_pVertexBuffer)
-        m_pVertexBuffer->Release();
-    if (m_pVertexLayout)
-        m_pVertexLayout->Release();
+    SafeRelease(m_pIndexBuffer);
+    SafeRelease(m_pVertexBuffer);
+    SafeRelease(m_pVertexLayout);
 }
 
 #pragma region Workers
@@ -54,135 +60,493 @@ void Mesh::Update(const float dT, const float rotationSpeed) noexcept
 }
 
 /*Software*/
-void Mesh::Rasterize(SDL_Surface* backBuffer, uint32_t* backBufferPixels, float* depthBuffer, const uint32_t width, const uint32_t height)
+void Mesh::Bin(TileBinner& binner)
 {
-    //Check if material on mesh should actually be rendered
-    if (MaterialManager::GetInstance()->GetMaterial(m_MaterialName)->HasTransparency())
+    //Check if material on mesh should actually be rendered, a stale handle means its material was removed
+    const auto* pMaterial = MaterialManager::GetInstance()->GetMaterial(m_MaterialHandle);
+    if (pMaterial == nullptr || (!SceneGraph::GetInstance()->IsTransparencyOn() && pMaterial->HasTransparency()))
         return;
 
+    // Material and render type can't change during a draw, so its kernels are picked once here instead of per pixel
+    const auto isMultisampled = SceneGraph::GetInstance()->GetSoftwareAntiAliasing() != SoftwareAntiAliasing::None;
+    SelectShadingKernels(pMaterial, SceneGraph::GetInstance()->GetSoftwareRenderType(), isMultisampled);
+
+    // Clipped triangles are appended behind the regular ones, their vertices behind the screen space vertices
+    m_ClippedIndexBuffer.Reset(&binner.GetFrameArena());
+
+    const auto cullMode = SceneGraph::GetInstance()->GetSoftwareCullMode();
+    const auto sampleReach = isMultisampled ? static_cast<float>(bgh::SampleReach) / 16.f : 0.f;
+    const auto width = static_cast<float>(binner.GetWidth());
+    const auto height = static_cast<float>(binner.GetHeight());
+
     for (uint32_t i = 0; i < m_IndexBuffer.size() - 2; i += 3)
     {
-        const auto i0 = m_IndexBuffer[i];
-        const auto i1 = m_IndexBuffer[i+1];
-        const auto i2 = m_IndexBuffer[i+2];
+        const auto clipCodes0 = m_SSVertices.clipCodes[m_IndexBuffer[i]];
+        const auto clipCodes1 = m_SSVertices.clipCodes[m_IndexBuffer[i + 1]];
+        const auto clipCodes2 = m_SSVertices.clipCodes[m_IndexBuffer[i + 2]];
 
-        const auto v0 = m_SSVertices.at(i0);
-        const auto v1 = m_SSVertices.at(i1);
-        const auto v2 = m_SSVertices.at(i2);
+        // Every vertex is outside of the same frustum plane
+        if ((clipCodes0 & clipCodes1 & clipCodes2 & bgh::ClipFrustum) != 0)
+            continue;
 
-        
-        if (v0.culled || v1.culled || v2.culled)
+        // Inside the guard band and in front of the near plane, the rasterizer can take it as is
+        const auto clipCodes = clipCodes0 | clipCodes1 | clipCodes2;
+        if ((clipCodes & bgh::ClipRequired) == 0)
+        {
+            BinTriangle(binner, i, cullMode, sampleReach);
             continue;
-        
-        RasterizeTriangle(v0, v1, v2, backBuffer, backBufferPixels, depthBuffer, width, height);
+        }
+
+        VertexOutput polygon[bgh::MaxClippedVertices];
+        for (uint32_t k = 0; k < 3; ++k)
+        {
+            polygon[k] = m_SSVertices.Get(m_IndexBuffer[i + k]);
+            if ((polygon[k].clipCodes & bgh::ClipRequired) == 0)
+                polygon[k].pos = bgh::ScreenToClip(polygon[k].pos, width, height);
+        }
+
+        const auto vertexCount = bgh::ClipTriangle(polygon, clipCodes);
+        if (vertexCount < 3)
+            continue;
+
+        const auto firstVertex = m_SSVertices.count;
+        for (uint32_t k = 0; k < vertexCount; ++k)
+        {
+            polygon[k].pos = bgh::ClipToScreen(polygon[k].pos, width, height);
+            m_SSVertices.PushBack(polygon[k]);
+        }
+
+        // The clipped polygon is convex, so a fan keeps the winding of the original triangle
+        for (uint32_t k = 1; k + 1 < vertexCount; ++k)
+        {
+            const auto firstIndex = static_cast<uint32_t>(m_IndexBuffer.size() + m_ClippedIndexBuffer.GetSize());
+            m_ClippedIndexBuffer.PushBack(firstVertex);
+            m_ClippedIndexBuffer.PushBack(firstVertex + k);
+            m_ClippedIndexBuffer.PushBack(firstVertex + k + 1);
+            BinTriangle(binner, firstIndex, cullMode, sampleReach);
+        }
     }
 }
 
+void Mesh::BinTriangle(TileBinner& binner, const uint32_t firstIndex, const SoftwareCullMode cullMode, const float sampleReach) const
+{
+    const auto* pIndices = GetTriangleIndices(firstIndex);
+    const auto p0 = m_SSVertices.GetScreenPos(pIndices[0]);
+    const auto p1 = m_SSVertices.GetScreenPos(pIndices[1]);
+    const auto p2 = m_SSVertices.GetScreenPos(pIndices[2]);
+
+    // Degenerate triangles never cover anything
+    const auto signedArea = (p1.x - p0.x) * (p2.y - p0.y) - (p1.y - p0.y) * (p2.x - p0.x);
+    if (signedArea == 0.f)
+        return;
+
+    // Same convention as the hardware rasterizer state (FrontCounterClockwise), with y pointing down that is a negative area
+    const auto isFrontFacing = signedArea < 0.f;
+    if ((cullMode == SoftwareCullMode::Back && !isFrontFacing) || (cullMode == SoftwareCullMode::Front && isFrontFacing))
+        return;
+
+    const auto minPoint = glm::min(p0, glm::min(p1, p2));
+    const auto maxPoint = glm::max(p0, glm::max(p1, p2));
+
+    // Slivers and tiny triangles that fall between pixel centers, or between samples when multisampling
+    const auto lowest = minPoint - 0.5f - sampleReach;
+    const auto highest = maxPoint - 0.5f + sampleReach;
+    if (std::ceil(lowest.x) > std::floor(highest.x) || std::ceil(lowest.y) > std::floor(highest.y))
+        return;
+
+    // Blended triangles go to their own bins, they're rasterized after everything opaque is done
+    binner.Bin(this, firstIndex, minPoint, maxPoint, m_pMaterial->HasTransparency());
+}
+
+bool Mesh::SetupTriangle(const uint32_t firstIndex, TriangleSetup& setup) const noexcept
+{
+    const auto* pIndices = GetTriangleIndices(firstIndex);
+    return setup.Setup(m_SSVertices.Get(pIndices[0]), m_SSVertices.Get(pIndices[1]), m_SSVertices.Get(pIndices[2]));
+}
 
-void Mesh::RasterizeTriangle(const VertexOutput& v0, const VertexOutput& v1, const VertexOutput& v2, SDL_Surface* backBuffer, uint32_t* backBufferPixels, float* depthBuffer, const uint32_t width, const uint32_t height) const noexcept 
+template <SoftwareRenderType RenderType, MaterialKind Kind>
+void Mesh::RasterizeTriangleKernel(const TriangleSetup& setup, const uint32_t visibilityId, const TileRect& tile, const FrameBuffer& frameBuffer) const noexcept
 {
-    const auto boundingBox = MakeBoundingBox(v0, v1, v2, width, height);
+    // Edge functions were set up once, they're stepped incrementally over the pixels
+    const auto& triEdges = setup.triEdges;
 
-    for (auto r = static_cast<uint32_t>(boundingBox.topLeft.y); r > static_cast<uint32_t>(boundingBox.bottomRight.y); --r)
+    // Bounding box of the triangle, clipped to the tile we're rasterizing
+    const auto minX = std::max(static_cast<int32_t>(tile.minX), triEdges.minX);
+    const auto minY = std::max(static_cast<int32_t>(tile.minY), triEdges.minY);
+    const auto maxX = std::min(static_cast<int32_t>(tile.maxX) - 1, triEdges.maxX);
+    const auto maxY = std::min(static_cast<int32_t>(tile.maxY) - 1, triEdges.maxY);
+
+    if (minX > maxX || minY > maxY)
+        return;
+
+    const auto& [edge0, edge1, edge2] = triEdges.edges;
+
+    const auto width = frameBuffer.width;
+    auto* depthBuffer = frameBuffer.pDepth;
+    auto* backBufferPixels = frameBuffer.pPixels;
+
+    const glm::ivec3 edgeSteps(edge0.a, edge1.a, edge2.a);
+    const glm::ivec3 rowSteps(edge0.b, edge1.b, edge2.b);
+    const auto depthRange = setup.DepthRange();
+
+    // After a depth pre-pass the depth buffer is final, so only fragments matching it are shaded and nothing is written back
+    const auto isEqualPass = frameBuffer.pass == RasterPass::ShadeEqual;
+
+    // Walk the bounding box in hierarchical Z blocks, a block row is exactly one span
+    static_assert(bsimd::SpanWidth == HiZBlockSize, "A hierarchical Z block row has to map to a single span");
+    for (auto blockY = static_cast<uint32_t>(minY) / HiZBlockSize; blockY <= static_cast<uint32_t>(maxY) / HiZBlockSize; ++blockY)
     {
-        for (auto c = static_cast<uint32_t>(boundingBox.topLeft.x); c < static_cast<uint32_t>(boundingBox.bottomRight.x); ++c)
-        {
-            TriangleResult triResult;
-            bgh::CalculateWeightArea(glm::vec2(c, r), v0, v1, v2, triResult);
+        const auto spanMinY = std::max(static_cast<uint32_t>(minY), blockY * HiZBlockSize);
+        const auto spanMaxY = std::min(static_cast<uint32_t>(maxY), blockY * HiZBlockSize + HiZBlockSize - 1);
 
-            if (!bgh::IsPointInTriangle(triResult))
+        for (auto blockX = static_cast<uint32_t>(minX) / HiZBlockSize; blockX <= static_cast<uint32_t>(maxX) / HiZBlockSize; ++blockX)
+        {
+            // The interpolated depth is clamped to the vertices' range, so blocks whose farthest depth is closer than the closest vertex are fully occluded
+            const auto blockMaxDepth = frameBuffer.GetHiZ(blockX, blockY);
+            if (isEqualPass ? setup.minDepth > blockMaxDepth : setup.minDepth >= blockMaxDepth)
                 continue;
 
-            const auto [w0, w1, w2] = triResult;
+            const auto spanMinX = std::max(static_cast<uint32_t>(minX), blockX * HiZBlockSize);
+            const auto laneCount = std::min(static_cast<uint32_t>(maxX), blockX * HiZBlockSize + HiZBlockSize - 1) - spanMinX + 1;
+
+            auto blockWritten = false;
+            auto spanEdges = glm::ivec3(
+                edge0.Evaluate(static_cast<int32_t>(spanMinX), static_cast<int32_t>(spanMinY)),
+                edge1.Evaluate(static_cast<int32_t>(spanMinX), static_cast<int32_t>(spanMinY)),
+                edge2.Evaluate(static_cast<int32_t>(spanMinX), static_cast<int32_t>(spanMinY)));
+
+            // Coverage and depth are resolved 8 pixels at a time, only the lanes that survive get interpolated and shaded
+            for (auto r = spanMinY; r <= spanMaxY; ++r, spanEdges += rowSteps)
+            {
+                const auto pixelIdx = spanMinX + (r * width);
+                const auto rowDepth = setup.SpanDepth(spanMinX, r);
+
+                float spanDepth[bsimd::SpanWidth];
+                const auto laneMask = isEqualPass
+                                          ? bsimd::DepthTestSpan<bsimd::DepthTest::Equal>(spanEdges, edgeSteps, rowDepth, depthRange, laneCount, depthBuffer + pixelIdx, spanDepth)
+                                          : bsimd::DepthTestSpan<bsimd::DepthTest::Less>(spanEdges, edgeSteps, rowDepth, depthRange, laneCount, depthBuffer + pixelIdx, spanDepth);
+                if (laneMask == 0)
+                    continue;
+                blockWritten = !isEqualPass;
+
+                // The depth-only kernel stops here, no interpolation or material lookups
+                if (frameBuffer.pass == RasterPass::DepthOnly)
+                    continue;
+
+                // Deferred shading only records which triangle won the pixel
+                if (frameBuffer.pVisibility != nullptr)
+                {
+                    uint32_t spanIds[bsimd::SpanWidth];
+                    std::fill_n(spanIds, bsimd::SpanWidth, visibilityId);
+                    bsimd::StoreMasked(frameBuffer.pVisibility + pixelIdx, spanIds, laneMask);
+                    continue;
+                }
+
+                // Lanes are shaded one by one, then packed into the back buffer's format together
+                float spanRed[bsimd::SpanWidth]{}, spanGreen[bsimd::SpanWidth]{}, spanBlue[bsimd::SpanWidth]{};
+                for (uint32_t lane = 0; lane < bsimd::SpanWidth; ++lane)
+                {
+                    if ((laneMask & (1u << lane)) == 0)
+                        continue;
+
+                    const auto pixel = glm::vec2(static_cast<float>(spanMinX + lane) + 0.5f, static_cast<float>(r) + 0.5f);
+                    const auto finalColor = ShadeFragmentKernel<RenderType, Kind>(setup, pixel, spanDepth[lane]);
+                    spanRed[lane] = finalColor.r;
+                    spanGreen[lane] = finalColor.g;
+                    spanBlue[lane] = finalColor.b;
+                }
+
+                uint32_t spanColors[bsimd::SpanWidth];
+                bsimd::PackColorSpan(spanRed, spanGreen, spanBlue, frameBuffer.format, spanColors);
+                bsimd::StoreMasked(backBufferPixels + pixelIdx, spanColors, laneMask);
+            }
+
+            if (blockWritten)
+                frameBuffer.RefreshHiZ(blockX, blockY);
+        }
+    }
+}
+
+template <SoftwareRenderType RenderType, MaterialKind Kind>
+void Mesh::RasterizeTriangleMultisampledKernel(const TriangleSetup& setup, const uint32_t visibilityId, const TileRect& tile, const FrameBuffer& frameBuffer) const noexcept
+{
+    const auto& triEdges = setup.triEdges;
+
+    // Samples reach past the pixel centers, so the bounds include every pixel with a sample the triangle can cover
+    const auto minX = std::max(static_cast<int32_t>(tile.minX), triEdges.sampleMinX);
+    const auto minY = std::max(static_cast<int32_t>(tile.minY), triEdges.sampleMinY);
+    const auto maxX = std::min(static_cast<int32_t>(tile.maxX) - 1, triEdges.sampleMaxX);
+    const auto maxY = std::min(static_cast<int32_t>(tile.maxY) - 1, triEdges.sampleMaxY);
+
+    if (minX > maxX || minY > maxY)
+        return;
+
+    const auto& [edge0, edge1, edge2] = triEdges.edges;
 
-            // Depth test
-            auto zDepth =
-                ((1.f / v0.pos.z) * w0) +
-                ((1.f / v1.pos.z) * w1) +
-                ((1.f / v2.pos.z) * w2);
+    const glm::ivec3 edgeSteps(edge0.a, edge1.a, edge2.a);
+    const glm::ivec3 rowSteps(edge0.b, edge1.b, edge2.b);
+    const auto depthRange = setup.DepthRange();
 
-            zDepth = 1.f / zDepth;
+    const auto isEqualPass = frameBuffer.pass == RasterPass::ShadeEqual;
 
-            if (zDepth < depthBuffer[c + (r * width)])
+    for (auto blockY = static_cast<uint32_t>(minY) / HiZBlockSize; blockY <= static_cast<uint32_t>(maxY) / HiZBlockSize; ++blockY)
+    {
+        const auto spanMinY = std::max(static_cast<uint32_t>(minY), blockY * HiZBlockSize);
+        const auto spanMaxY = std::min(static_cast<uint32_t>(maxY), blockY * HiZBlockSize + HiZBlockSize - 1);
+
+        for (auto blockX = static_cast<uint32_t>(minX) / HiZBlockSize; blockX <= static_cast<uint32_t>(maxX) / HiZBlockSize; ++blockX)
+        {
+            // Hierarchical Z holds the farthest sample of the block
+            const auto blockMaxDepth = frameBuffer.GetHiZ(blockX, blockY);
+            if (isEqualPass ? setup.minDepth > blockMaxDepth : setup.minDepth >= blockMaxDepth)
+                continue;
+
+            const auto spanMinX = std::max(static_cast<uint32_t>(minX), blockX * HiZBlockSize);
+            const auto laneCount = std::min(static_cast<uint32_t>(maxX), blockX * HiZBlockSize + HiZBlockSize - 1) - spanMinX + 1;
+
+            auto blockWritten = false;
+            auto spanEdges = glm::ivec3(
+                edge0.Evaluate(static_cast<int32_t>(spanMinX), static_cast<int32_t>(spanMinY)),
+                edge1.Evaluate(static_cast<int32_t>(spanMinX), static_cast<int32_t>(spanMinY)),
+                edge2.Evaluate(static_cast<int32_t>(spanMinX), static_cast<int32_t>(spanMinY)));
+
+            // Coverage and depth are resolved per sample, a pixel with any sample left is shaded once and its color goes to those samples only
+            for (auto r = spanMinY; r <= spanMaxY; ++r, spanEdges += rowSteps)
             {
-                depthBuffer[c + (r * width)] = zDepth;
-                
-                auto depth =     
-                    ((1.f / v0.pos.w) * w0) +
-                    ((1.f / v1.pos.w) * w1) +
-                    ((1.f / v2.pos.w) * w2);
-                
-                depth = 1.f / depth;
-
-                const auto interpolatedAttributes = Interpolate(v0, v1, v2, triResult, depth);
-
-                RGBColor finalColor{};
-                switch (SceneGraph::GetInstance()->GetSoftwareRenderType())
+                const auto sampleIdx = frameBuffer.GetSampleIdx(spanMinX, r);
+                const auto rowDepth = setup.SpanDepth(spanMinX, r);
+
+                float sampleDepth[bgh::SampleCount][bsimd::SpanWidth];
+                const auto coverageMask = isEqualPass
+                                              ? bsimd::DepthTestSamples<bsimd::DepthTest::Equal>(spanEdges, triEdges.sampleOffsets, edgeSteps, rowDepth, setup.sampleDepthOffsets, depthRange, laneCount, frameBuffer.pDepth + sampleIdx, sampleDepth)
+                                              : bsimd::DepthTestSamples<bsimd::DepthTest::Less>(spanEdges, triEdges.sampleOffsets, edgeSteps, rowDepth, setup.sampleDepthOffsets, depthRange, laneCount, frameBuffer.pDepth + sampleIdx, sampleDepth);
+                if (coverageMask == 0)
+                    continue;
+                blockWritten = !isEqualPass;
+
+                if (frameBuffer.pass == RasterPass::DepthOnly)
+                    continue;
+
+                if (frameBuffer.pVisibility != nullptr)
                 {
-                case SoftwareRenderType::Color:
-                    finalColor = PixelShading(interpolatedAttributes);
-                    break;
-                case SoftwareRenderType::Depth:
-                    finalColor = RGBColor(bme::Remap(zDepth, 0.985f, 1.f));
-                    break;
-                case SoftwareRenderType::Normal:
-                    finalColor = glm::abs(interpolatedAttributes.normal);
-                    break;
-                case SoftwareRenderType::NormalMapped:
-                    finalColor = glm::abs(MaterialManager::GetInstance()->GetMaterial(m_MaterialName)->GetMappedNormal(interpolatedAttributes));
-                    break;
+                    uint32_t spanIds[bsimd::SpanWidth];
+                    std::fill_n(spanIds, bsimd::SpanWidth, visibilityId);
+                    for (uint32_t sample = 0; sample < bgh::SampleCount; ++sample)
+                    {
+                        bsimd::StoreMasked(frameBuffer.pVisibility + sampleIdx + sample * bsimd::SpanWidth, spanIds, coverageMask >> (sample * bsimd::SpanWidth) & 0xFF);
+                    }
+                    continue;
                 }
 
-                backBufferPixels[c + (r * width)] = SDL_MapRGB(backBuffer->format,
-                                                               static_cast<uint8_t>(finalColor.r * 255),
-                                                               static_cast<uint8_t>(finalColor.g * 255),
-                                                               static_cast<uint8_t>(finalColor.b * 255));
+                // Shaded at the pixel center, like hardware multisampling without centroid interpolation
+                const auto laneMask = bsimd::GetCoveredLanes<bgh::SampleCount>(coverageMask);
+                float spanRed[bsimd::SpanWidth]{}, spanGreen[bsimd::SpanWidth]{}, spanBlue[bsimd::SpanWidth]{};
+                for (uint32_t lane = 0; lane < bsimd::SpanWidth; ++lane)
+                {
+                    if ((laneMask & (1u << lane)) == 0)
+                        continue;
+
+                    // The depth view shows the first sample the triangle covers
+                    const auto firstSample = bsimd::GetFirstSample(coverageMask, lane);
+                    const auto pixel = glm::vec2(static_cast<float>(spanMinX + lane) + 0.5f, static_cast<float>(r) + 0.5f);
+                    const auto finalColor = ShadeFragmentKernel<RenderType, Kind>(setup, pixel, sampleDepth[firstSample][lane]);
+                    spanRed[lane] = finalColor.r;
+                    spanGreen[lane] = finalColor.g;
+                    spanBlue[lane] = finalColor.b;
+                }
+
+                uint32_t spanColors[bsimd::SpanWidth];
+                bsimd::PackColorSpan(spanRed, spanGreen, spanBlue, frameBuffer.format, spanColors);
+                for (uint32_t sample = 0; sample < bgh::SampleCount; ++sample)
+                {
+                    bsimd::StoreMasked(frameBuffer.pSampleColors + sampleIdx + sample * bsimd::SpanWidth, spanColors, coverageMask >> (sample * bsimd::SpanWidth) & 0xFF);
+                }
             }
+
+            if (blockWritten)
+                frameBuffer.RefreshHiZ(blockX, blockY);
         }
     }
 }
 
-RGBColor Mesh::PixelShading(const VertexOutput& v) const noexcept
+template <SoftwareRenderType RenderType, MaterialKind Kind>
+void Mesh::BlendTriangleKernel(const TriangleSetup& setup, uint32_t, const TileRect& tile, const FrameBuffer& frameBuffer) const noexcept
 {
-   //RGBColor finalColor = {0.f, 0.f, 0.f};
+    const auto& triEdges = setup.triEdges;
+    const auto isMultisampled = frameBuffer.sampleCount > 1;
+
+    // Bounding box of the triangle, clipped to the tile we're rasterizing
+    const auto minX = std::max(static_cast<int32_t>(tile.minX), isMultisampled ? triEdges.sampleMinX : triEdges.minX);
+    const auto minY = std::max(static_cast<int32_t>(tile.minY), isMultisampled ? triEdges.sampleMinY : triEdges.minY);
+    const auto maxX = std::min(static_cast<int32_t>(tile.maxX) - 1, isMultisampled ? triEdges.sampleMaxX : triEdges.maxX);
+    const auto maxY = std::min(static_cast<int32_t>(tile.maxY) - 1, isMultisampled ? triEdges.sampleMaxY : triEdges.maxY);
+
+    if (minX > maxX || minY > maxY)
+        return;
 
-   const glm::vec3 lightDirection = {0.577f, -0.577f, -0.577f};
+    const auto& [edge0, edge1, edge2] = triEdges.edges;
+    const auto width = frameBuffer.width;
 
-   //const auto lightIntensity = 7.f;
-   //const RGBColor lightColor = {1.f, 1.f, 1.f};
+    const glm::ivec3 edgeSteps(edge0.a, edge1.a, edge2.a);
+    const glm::ivec3 rowSteps(edge0.b, edge1.b, edge2.b);
+    const auto depthRange = setup.DepthRange();
 
-   //const auto mappedNormal = MaterialManager::GetInstance()->GetMaterial(m_MaterialId)->GetMappedNormal(v);
+    // Same block walk as the opaque kernel, but the depth buffer and hierarchical Z are only read
+    for (auto blockY = static_cast<uint32_t>(minY) / HiZBlockSize; blockY <= static_cast<uint32_t>(maxY) / HiZBlockSize; ++blockY)
+    {
+        const auto spanMinY = std::max(static_cast<uint32_t>(minY), blockY * HiZBlockSize);
+        const auto spanMaxY = std::min(static_cast<uint32_t>(maxY), blockY * HiZBlockSize + HiZBlockSize - 1);
+
+        for (auto blockX = static_cast<uint32_t>(minX) / HiZBlockSize; blockX <= static_cast<uint32_t>(maxX) / HiZBlockSize; ++blockX)
+        {
+            if (setup.minDepth >= frameBuffer.GetHiZ(blockX, blockY))
+                continue;
 
-   //const auto lambertCosine = std::max(0.f, glm::dot(-mappedNormal, lightDirection));
+            const auto spanMinX = std::max(static_cast<uint32_t>(minX), blockX * HiZBlockSize);
+            const auto laneCount = std::min(static_cast<uint32_t>(maxX), blockX * HiZBlockSize + HiZBlockSize - 1) - spanMinX + 1;
 
-   //finalColor = (lightColor * lightIntensity / glm::pi<float>()) * MaterialManager::GetInstance()->GetMaterial(m_MaterialId)->Shade(v, lightDirection, v.viewDirection, mappedNormal) *
-   //    lambertCosine;
+            auto spanEdges = glm::ivec3(
+                edge0.Evaluate(static_cast<int32_t>(spanMinX), static_cast<int32_t>(spanMinY)),
+                edge1.Evaluate(static_cast<int32_t>(spanMinX), static_cast<int32_t>(spanMinY)),
+                edge2.Evaluate(static_cast<int32_t>(spanMinX), static_cast<int32_t>(spanMinY)));
 
-   //MaxToOne(finalColor);
-    const auto pMat = MaterialManager::GetInstance()->GetMaterial(m_MaterialName);
-    return pMat->Shade(v, lightDirection, v.viewDirection, {});
+            for (auto r = spanMinY; r <= spanMaxY; ++r, spanEdges += rowSteps)
+            {
+                const auto pixelIdx = spanMinX + (r * width);
+                const auto rowDepth = setup.SpanDepth(spanMinX, r);
+
+                // Multisampled, the blended fragment is tested per sample and its opacity scaled by the share of samples it covers
+                float sampleDepth[bgh::SampleCount][bsimd::SpanWidth];
+                const auto coverageMask = isMultisampled
+                                              ? bsimd::DepthTestSamples<bsimd::DepthTest::LessReadOnly>(spanEdges, triEdges.sampleOffsets, edgeSteps, rowDepth, setup.sampleDepthOffsets, depthRange, laneCount, frameBuffer.pDepth + frameBuffer.GetSampleIdx(spanMinX, r), sampleDepth)
+                                              : bsimd::DepthTestSpan<bsimd::DepthTest::LessReadOnly>(spanEdges, edgeSteps, rowDepth, depthRange, laneCount, frameBuffer.pDepth + pixelIdx, sampleDepth[0]);
+                if (coverageMask == 0)
+                    continue;
+
+                const auto laneMask = isMultisampled ? bsimd::GetCoveredLanes<bgh::SampleCount>(coverageMask) : coverageMask;
+                for (uint32_t lane = 0; lane < bsimd::SpanWidth; ++lane)
+                {
+                    if ((laneMask & (1u << lane)) == 0)
+                        continue;
+
+                    const auto pixel = glm::vec2(static_cast<float>(spanMinX + lane) + 0.5f, static_cast<float>(r) + 0.5f);
+                    const auto viewDepth = 1.f / setup.invW.Evaluate(pixel - setup.origin);
+                    // Without multisampling the lane bits are sample 0, so this also holds for the single sample path
+                    const auto firstSample = bsimd::GetFirstSample(coverageMask, lane);
+                    auto color = BlendFragmentKernel<RenderType, Kind>(setup, pixel, sampleDepth[firstSample][lane]);
+                    if (isMultisampled)
+                        color.a *= static_cast<float>(std::popcount(coverageMask >> lane & 0x01010101u)) / static_cast<float>(bgh::SampleCount);
+                    frameBuffer.Accumulate(pixelIdx + lane, color, viewDepth);
+                }
+            }
+        }
+    }
 }
 
-BoundingBox2D Mesh::MakeBoundingBox(const VertexOutput& v0, const VertexOutput& v1, const VertexOutput& v2, const uint32_t maxScreenWidth, const uint32_t maxScreenHeight) const noexcept
+template <SoftwareRenderType RenderType, MaterialKind Kind>
+glm::vec4 Mesh::BlendFragmentKernel(const TriangleSetup& setup, const glm::vec2& pixel, const float zDepth) const noexcept
 {
-    BoundingBox2D boundingBox{ {static_cast<float>(maxScreenWidth - 1), static_cast<float>(maxScreenHeight - 1)}, {0,0} };
+    // Only flat materials carry an opacity, the debug render types keep it so blended surfaces look the same in every view
+    if constexpr (Kind == MaterialKind::Flat)
+    {
+        const auto color = static_cast<const MaterialFlat&>(*m_pMaterial).ShadeBlended(setup.Interpolate(pixel));
+        if constexpr (RenderType == SoftwareRenderType::Color)
+            return color;
+        else
+            return glm::vec4(ShadeFragmentKernel<RenderType, Kind>(setup, pixel, zDepth), color.a);
+    }
+    else
+    {
+        return glm::vec4(ShadeFragmentKernel<RenderType, Kind>(setup, pixel, zDepth), 1.f);
+    }
+}
 
-    for (auto& v : {v0, v1, v2})
+template <SoftwareRenderType RenderType, MaterialKind Kind>
+RGBColor Mesh::ShadeFragmentKernel(const TriangleSetup& setup, const glm::vec2& pixel, const float zDepth) const noexcept
+{
+    // Both material classes are final, so the calls below are bound statically and the material math inlines into the kernel
+    using MaterialType = std::conditional_t<Kind == MaterialKind::Mapped, MaterialMapped, MaterialFlat>;
+
+    if constexpr (RenderType == SoftwareRenderType::Depth)
     {
-        boundingBox.Expand(glm::vec2(v.pos));
+        return RGBColor(bme::Remap(zDepth, 0.985f, 1.f));
     }
-    boundingBox.AddMargin(1);
-    
-    boundingBox.Clamp({0.f, 0.f}, { maxScreenWidth, maxScreenHeight});
-    return boundingBox;
+    else if constexpr (RenderType == SoftwareRenderType::Normal)
+    {
+        return glm::abs(setup.InterpolateNormal(pixel));
+    }
+    else
+    {
+        const auto& material = static_cast<const MaterialType&>(*m_pMaterial);
+        const auto interpolatedAttributes = setup.Interpolate(pixel);
+
+        if constexpr (RenderType == SoftwareRenderType::NormalMapped)
+        {
+            return glm::abs(material.GetMappedNormal(interpolatedAttributes));
+        }
+        else
+        {
+            constexpr glm::vec3 lightDirection = {0.577f, -0.577f, -0.577f};
+            return material.Shade(interpolatedAttributes, lightDirection, interpolatedAttributes.viewDirection, {});
+        }
+    }
+}
+
+void Mesh::SelectShadingKernels(const Material* pMaterial, const SoftwareRenderType renderType, const bool isMultisampled) noexcept
+{
+    m_pMaterial = pMaterial;
+    switch (pMaterial->GetKind())
+    {
+    case MaterialKind::Flat:
+        SelectShadingKernels<MaterialKind::Flat>(renderType, isMultisampled);
+        break;
+    case MaterialKind::Mapped:
+        SelectShadingKernels<MaterialKind::Mapped>(renderType, isMultisampled);
+        break;
+    }
+}
+
+template <MaterialKind Kind>
+void Mesh::SelectShadingKernels(const SoftwareRenderType renderType, const bool isMultisampled) noexcept
+{
+    switch (renderType)
+    {
+    case SoftwareRenderType::Color:
+        SelectShadingKernels<SoftwareRenderType::Color, Kind>(isMultisampled);
+        break;
+    case SoftwareRenderType::Depth:
+        SelectShadingKernels<SoftwareRenderType::Depth, Kind>(isMultisampled);
+        break;
+    case SoftwareRenderType::Normal:
+        SelectShadingKernels<SoftwareRenderType::Normal, Kind>(isMultisampled);
+        break;
+    case SoftwareRenderType::NormalMapped:
+        SelectShadingKernels<SoftwareRenderType::NormalMapped, Kind>(isMultisampled);
+        break;
+    }
+}
+
+template <SoftwareRenderType RenderType, MaterialKind Kind>
+void Mesh::SelectShadingKernels(const bool isMultisampled) noexcept
+{
+    // Blended materials never reach the opaque kernels and single sampled draws never see a sample mask, so neither pays for the other
+    if (m_pMaterial->HasTransparency())
+        m_pRasterizeKernel = &Mesh::BlendTriangleKernel<RenderType, Kind>;
+    else if (isMultisampled)
+        m_pRasterizeKernel = &Mesh::RasterizeTriangleMultisampledKernel<RenderType, Kind>;
+    else
+        m_pRasterizeKernel = &Mesh::RasterizeTriangleKernel<RenderType, Kind>;
+    m_pShadeKernel = &Mesh::ShadeFragmentKernel<RenderType, Kind>;
 }
 
 
 /*D3D*/
+#ifndef HYBRID_HEADLESS
 void Mesh::Render(ID3D11DeviceContext* pDeviceContext, Camera* pCamera) const noexcept
 {
     //Check if material of mesh should actually be rendered
-    if (!SceneGraph::GetInstance()->IsTransparencyOn() && MaterialManager::GetInstance()->GetMaterial(m_MaterialName)->HasTransparency())
+    auto* pMaterial = MaterialManager::GetInstance()->GetMaterial(m_MaterialHandle);
+    if (pMaterial == nullptr || (!SceneGraph::GetInstance()->IsTransparencyOn() && pMaterial->HasTransparency()))
     {
         return;
     }
@@ -202,24 +566,26 @@ void Mesh::Render(ID3D11DeviceContext* pDeviceContext, Camera* pCamera) const no
     pDeviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 
     //Set Matrix
-    MaterialManager::GetInstance()->GetMaterial(m_MaterialName)->SetMatrices(pCamera->GetProjectionMatrix(), pCamera->GetViewMatrix(), m_WorldMatrix);
+    pMaterial->SetMatrices(pCamera->GetProjectionMatrix(), pCamera->GetViewMatrix(), m_WorldMatrix);
 
     //Set Maps (material-dependant)
-    MaterialManager::GetInstance()->GetMaterial(m_MaterialName)->SetMaps();
+    pMaterial->SetMaps();
 
     //Render a triangle
     D3DX11_TECHNIQUE_DESC techDesc;
-    MaterialManager::GetInstance()->GetMaterial(m_MaterialName)->GetTechnique()->GetDesc(&techDesc);
+    pMaterial->GetTechnique()->GetDesc(&techDesc);
     for (UINT p = 0; p < techDesc.Passes; ++p)
     {
-        MaterialManager::GetInstance()->GetMaterial(m_MaterialName)->GetTechnique()->GetPassByIndex(p)->Apply(0, pDeviceContext);
+        pMaterial->GetTechnique()->GetPassByIndex(p)->Apply(0, pDeviceContext);
 
         pDeviceContext->DrawIndexed(m_AmountIndices, 0, 0);
     }
 }
+#endif
 
-void Mesh::MakeMesh(ID3D11Device* pDevice, const std::vector<uint32_t>& indices, const std::vector<VertexInput>& vertices)
+void Mesh::MakeMesh([[maybe_unused]] ID3D11Device* pDevice, const std::vector<uint32_t>& indices, const std::vector<VertexInput>& vertices)
 {
+#ifndef HYBRID_HEADLESS
     /*D3D Initialization*/
     //Create Vertex Layout
     HRESULT result = S_OK;
@@ -249,7 +615,7 @@ void Mesh::MakeMesh(ID3D11Device* pDevice, const std::vector<uint32_t>& indices,
 
     //Create the input layout
     D3DX11_PASS_DESC passDesc;
-    MaterialManager::GetInstance()->GetMaterial(m_MaterialName)->GetTechnique()->GetPassByIndex(0)->GetDesc(&passDesc);
+    MaterialManager::GetInstance()->GetMaterial(m_MaterialHandle)->GetTechnique()->GetPassByIndex(0)->GetDesc(&passDesc);
 
     result = pDevice->CreateInputLayout(
         vertexDesc,
@@ -295,10 +661,12 @@ void Mesh::MakeMesh(ID3D11Device* pDevice, const std::vector<uint32_t>& indices,
     result = pDevice->CreateBuffer(&bd, &initData, &m_pIndexBuffer);
     if (FAILED(result))
         return;
+#endif
 
     /*Software Initialization*/
     m_IndexBuffer = indices;
     m_VertexBuffer = vertices;
+    m_VertexStreams.Assign(vertices);
 }
 
 #pragma endregion Workers
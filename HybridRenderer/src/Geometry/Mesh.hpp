@@ -1,11 +1,13 @@
 #ifndef MESH_HPP
 #define MESH_HPP
 
+#ifndef HYBRID_HEADLESS
 //DirectX Headers
 #include <dxgi.h>
 #include <d3d11.h>
 #include <d3dcompiler.h>
 #include <d3dx11effect.h>
+#endif
 
 //General includes
 #include <vector>
@@ -17,6 +19,7 @@
 #include "Helpers/Vertex.hpp"
 #include "Helpers/MeshParser.hpp"
 #include "Materials/Material.hpp"
+#include "Rendering/FrameBuffer.hpp"
 
 
 enum class PrimitiveTopology
@@ -26,11 +29,14 @@ enum class PrimitiveTopology
 };
 
 class Camera;
+class TileBinner;
+struct TriangleSetup;
+enum class SoftwareCullMode;
 
 class Mesh final
 {
 public:
-    Mesh(ID3D11Device* pDevice, const std::string& modelPath, Material* pMaterial, const glm::vec3& origin = {0, 0, 0});
+    Mesh(ID3D11Device* pDevice, const std::string& modelPath, MaterialHandle material, const glm::vec3& origin = {0, 0, 0});
     
     ~Mesh();
     DEL_ROF(Mesh)
@@ -39,7 +45,17 @@ public:
     /*General*/
     void Update(float dT, float rotationSpeed) noexcept;
     /*Software*/
-    void Rasterize(SDL_Surface* backBuffer, uint32_t* backBufferPixels, float* depthBuffer, uint32_t width, uint32_t height);
+    void Bin(TileBinner& binner);
+    [[nodiscard]] bool SetupTriangle(uint32_t firstIndex, TriangleSetup& setup) const noexcept;
+    //Both run the kernels Bin picked for this draw's render type and material
+    void RasterizeTriangle(const TriangleSetup& setup, const uint32_t visibilityId, const TileRect& tile, const FrameBuffer& frameBuffer) const noexcept
+    {
+        (this->*m_pRasterizeKernel)(setup, visibilityId, tile, frameBuffer);
+    }
+    [[nodiscard]] RGBColor ShadeFragment(const TriangleSetup& setup, const glm::vec2& pixel, const float zDepth) const noexcept
+    {
+        return (this->*m_pShadeKernel)(setup, pixel, zDepth);
+    }
     /*D3D*/
     void Render(ID3D11DeviceContext* pDeviceContext, Camera* pCamera) const noexcept;
 
@@ -47,20 +63,22 @@ public:
     //Setters
     /*General*/
     void SetWorld(const glm::mat4& worldMat) { m_WorldMatrix = worldMat; }
-    
-    /*Software*/
-    void SetScreenSpaceVertices(const std::vector<VertexOutput>& vertices) { m_SSVertices = vertices; }
 
     //Getters
     /*General*/
-    [[nodiscard]] constexpr auto GetMaterialName() const noexcept -> std::string_view { return m_MaterialName; }
+    [[nodiscard]] constexpr auto GetMaterialHandle() const noexcept -> MaterialHandle { return m_MaterialHandle; }
     [[nodiscard]] auto GetWorld() const noexcept -> glm::mat4 { return m_WorldMatrix; }
     [[nodiscard]] constexpr auto GetVertices() const noexcept -> const std::vector<VertexInput>& { return m_VertexBuffer; }
 
+    /*Software*/
+    [[nodiscard]] constexpr auto GetVertexStreams() const noexcept -> const VertexInputStreams& { return m_VertexStreams; }
+    //Written by the camera's vertex kernel every frame
+    [[nodiscard]] auto GetScreenSpaceVertices() noexcept -> VertexOutputStreams& { return m_SSVertices; }
+
 
 private:
     /*General*/
-    std::string_view m_MaterialName;
+    MaterialHandle m_MaterialHandle;
     glm::mat4 m_WorldMatrix;
     glm::vec3 m_Origin;
     float m_RotationAngle;
@@ -70,19 +88,47 @@ private:
     std::vector<uint32_t> m_IndexBuffer;
     std::vector<VertexInput> m_VertexBuffer;
     std::vector<VertexInput> m_HardwareVertexBuffer;
-    std::vector<VertexOutput> m_SSVertices;
-
-    [[nodiscard]] RGBColor PixelShading(const VertexOutput& v) const noexcept;
-    [[nodiscard]] BoundingBox2D MakeBoundingBox(const VertexOutput& v0, const VertexOutput& v1, const VertexOutput& v2, uint32_t maxScreenWidth = INT_MAX,
-                                                                 uint32_t maxScreenHeight = INT_MAX) const noexcept;
-
-    void RasterizeTriangle(const VertexOutput& v0, const VertexOutput& v1, const VertexOutput& v2, SDL_Surface* backBuffer, uint32_t* backBufferPixels, float* depthBuffer, uint32_t width, uint32_t height) const noexcept;
+    VertexInputStreams m_VertexStreams;
+    VertexOutputStreams m_SSVertices;
+    ArenaVector<uint32_t> m_ClippedIndexBuffer;
+
+    void BinTriangle(TileBinner& binner, uint32_t firstIndex, SoftwareCullMode cullMode, float sampleReach) const;
+    //Triangles past the end of the index buffer were produced by clipping this frame
+    [[nodiscard]] auto GetTriangleIndices(const uint32_t firstIndex) const noexcept -> const uint32_t*
+    {
+        return firstIndex < m_IndexBuffer.size() ? &m_IndexBuffer[firstIndex] : &m_ClippedIndexBuffer[firstIndex - static_cast<uint32_t>(m_IndexBuffer.size())];
+    }
+
+    //Shading kernels, specialized per render type and material kind so the pixel loop has no runtime dispatch left
+    using RasterizeKernel = void (Mesh::*)(const TriangleSetup&, uint32_t, const TileRect&, const FrameBuffer&) const noexcept;
+    using ShadeKernel = RGBColor (Mesh::*)(const TriangleSetup&, const glm::vec2&, float) const noexcept;
+    const Material* m_pMaterial = nullptr;
+    RasterizeKernel m_pRasterizeKernel = nullptr;
+    ShadeKernel m_pShadeKernel = nullptr;
+
+    void SelectShadingKernels(const Material* pMaterial, SoftwareRenderType renderType, bool isMultisampled) noexcept;
+    template <MaterialKind Kind>
+    void SelectShadingKernels(SoftwareRenderType renderType, bool isMultisampled) noexcept;
+    template <SoftwareRenderType RenderType, MaterialKind Kind>
+    void SelectShadingKernels(bool isMultisampled) noexcept;
+    template <SoftwareRenderType RenderType, MaterialKind Kind>
+    void RasterizeTriangleKernel(const TriangleSetup& setup, uint32_t visibilityId, const TileRect& tile, const FrameBuffer& frameBuffer) const noexcept;
+    //Kernel for 4x multisampling, coverage and depth per sample in the frame buffer's sample layout, shading once per pixel
+    template <SoftwareRenderType RenderType, MaterialKind Kind>
+    void RasterizeTriangleMultisampledKernel(const TriangleSetup& setup, uint32_t visibilityId, const TileRect& tile, const FrameBuffer& frameBuffer) const noexcept;
+    //Kernel of blended materials, tests against the opaque depth without writing it and accumulates into the order independent transparency buffers
+    template <SoftwareRenderType RenderType, MaterialKind Kind>
+    void BlendTriangleKernel(const TriangleSetup& setup, uint32_t visibilityId, const TileRect& tile, const FrameBuffer& frameBuffer) const noexcept;
+    template <SoftwareRenderType RenderType, MaterialKind Kind>
+    [[nodiscard]] glm::vec4 BlendFragmentKernel(const TriangleSetup& setup, const glm::vec2& pixel, float zDepth) const noexcept;
+    template <SoftwareRenderType RenderType, MaterialKind Kind>
+    [[nodiscard]] RGBColor ShadeFragmentKernel(const TriangleSetup& setup, const glm::vec2& pixel, float zDepth) const noexcept;
     
     /*D3D*/
-    ID3D11InputLayout* m_pVertexLayout;
-    ID3D11Buffer* m_pVertexBuffer;
-    ID3D11Buffer* m_pIndexBuffer;
-    uint32_t m_AmountIndices;
+    ID3D11InputLayout* m_pVertexLayout = nullptr;
+    ID3D11Buffer* m_pVertexBuffer = nullptr;
+    ID3D11Buffer* m_pIndexBuffer = nullptr;
+    uint32_t m_AmountIndices = 0;
 
     void MakeMesh(ID3D11Device* pDevice, const std::vector<uint32_t>& indices, const std::vector<VertexInput>& vertices);
 };
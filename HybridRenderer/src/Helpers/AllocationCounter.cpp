@@ -0,0 +1,76 @@
+#include "pch.h"
+#include "Helpers/AllocationCounter.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    std::atomic<uint64_t> g_AllocationCount{0};
+    thread_local uint32_t t_IgnoreDepth = 0;
+}
+
+uint64_t AllocationCounter::GetAllocationCount() noexcept
+{
+    return g_AllocationCount.load(std::memory_order_relaxed);
+}
+
+AllocationCounter::IgnoreScope::IgnoreScope() noexcept
+{
+    ++t_IgnoreDepth;
+}
+
+AllocationCounter::IgnoreScope::~IgnoreScope()
+{
+    --t_IgnoreDepth;
+}
+
+// Replacing the plain and aligned operator new/delete pairs is enough, the array and nothrow versions forward to them
+void* operator new(const std::size_t size)
+{
+    if (t_IgnoreDepth == 0)
+        g_AllocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (auto* pMemory = std::malloc(size == 0 ? 1 : size))
+        return pMemory;
+    throw std::bad_alloc{};
+}
+
+void* operator new(const std::size_t size, const std::align_val_t alignment)
+{
+    if (t_IgnoreDepth == 0)
+        g_AllocationCount.fetch_add(1, std::memory_order_relaxed);
+    const auto align = static_cast<std::size_t>(alignment);
+#if defined(_MSC_VER)
+    auto* pMemory = _aligned_malloc(size == 0 ? 1 : size, align);
+#else
+    auto* pMemory = std::aligned_alloc(align, ((size == 0 ? 1 : size) + align - 1) / align * align);
+#endif
+    if (pMemory)
+        return pMemory;
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* pMemory) noexcept
+{
+    std::free(pMemory);
+}
+
+void operator delete(void* pMemory, std::size_t) noexcept
+{
+    std::free(pMemory);
+}
+
+void operator delete(void* pMemory, std::align_val_t) noexcept
+{
+#if defined(_MSC_VER)
+    _aligned_free(pMemory);
+#else
+    std::free(pMemory);
+#endif
+}
+
+void operator delete(void* pMemory, std::size_t, const std::align_val_t alignment) noexcept
+{
+    operator delete(pMemory, alignment);
+}
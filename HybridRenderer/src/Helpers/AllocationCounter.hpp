@@ -0,0 +1,24 @@
+#ifndef ALLOCATION_COUNTER_HPP
+#define ALLOCATION_COUNTER_HPP
+
+//Standard includes
+#include <cstdint>
+
+//Counts every call to the global operator new, so a stretch of code can prove it does not touch the heap
+namespace AllocationCounter
+{
+    [[nodiscard]] uint64_t GetAllocationCount() noexcept;
+
+    //Allocations the calling thread makes while this is alive are not counted, for work that overlaps a measured stretch on other threads
+    class IgnoreScope final
+    {
+    public:
+        IgnoreScope() noexcept;
+        ~IgnoreScope();
+
+        IgnoreScope(const IgnoreScope&) = delete;
+        IgnoreScope& operator=(const IgnoreScope&) = delete;
+    };
+}
+
+#endif // !ALLOCATION_COUNTER_HPP
@@ -0,0 +1,78 @@
+#include "pch.h"
+#include "Helpers/FrameArena.hpp"
+
+#include "Debugging/Logger.hpp"
+
+namespace
+{
+    //Every block is aligned for the widest SIMD loads
+    constexpr size_t BlockAlignment = 64;
+
+    std::byte* AllocateBlock(const size_t size)
+    {
+        return static_cast<std::byte*>(::operator new(size, std::align_val_t{BlockAlignment}));
+    }
+
+    void FreeBlock(std::byte* pBlock) noexcept
+    {
+        ::operator delete(pBlock, std::align_val_t{BlockAlignment});
+    }
+}
+
+FrameArena::FrameArena(const size_t capacity)
+    : m_pBlock(AllocateBlock(capacity)),
+      m_Capacity(capacity),
+      m_Offset(0),
+      m_UsedBytes(0)
+{
+}
+
+FrameArena::~FrameArena()
+{
+    for (auto* pBlock : m_OverflowBlocks)
+    {
+        FreeBlock(pBlock);
+    }
+    FreeBlock(m_pBlock);
+}
+
+#pragma region Workers
+void* FrameArena::Allocate(const size_t size, const size_t alignment)
+{
+    m_UsedBytes += size;
+
+    const auto alignedOffset = (m_Offset + alignment - 1) & ~(alignment - 1);
+    if (alignedOffset + size <= m_Capacity)
+    {
+        m_Offset = alignedOffset + size;
+        return m_pBlock + alignedOffset;
+    }
+
+    // Out of space, this frame gets a dedicated block and Reset makes sure the next one fits
+    auto* pBlock = AllocateBlock(std::max(size, alignment));
+    m_OverflowBlocks.push_back(pBlock);
+    return pBlock;
+}
+
+void FrameArena::Reset()
+{
+    if (!m_OverflowBlocks.empty())
+    {
+        for (auto* pBlock : m_OverflowBlocks)
+        {
+            FreeBlock(pBlock);
+        }
+        m_OverflowBlocks.clear();
+
+        // Leave some headroom, so a slightly heavier frame does not overflow again
+        const auto newCapacity = m_UsedBytes + m_UsedBytes / 2;
+        LOG(LEVEL_INFO, "Frame arena grown from " << m_Capacity / 1024 << "KB to " << newCapacity / 1024 << "KB")
+        FreeBlock(m_pBlock);
+        m_pBlock = AllocateBlock(newCapacity);
+        m_Capacity = newCapacity;
+    }
+
+    m_Offset = 0;
+    m_UsedBytes = 0;
+}
+#pragma endregion
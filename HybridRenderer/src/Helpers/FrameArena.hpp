@@ -0,0 +1,98 @@
+#ifndef FRAME_ARENA_HPP
+#define FRAME_ARENA_HPP
+
+//Standard includes
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+//Linear allocator for data that only lives for a single frame, everything is released at once by Reset.
+//Allocating is not thread safe, transient buffers are allocated up front by the thread running the frame and filled in by the jobs.
+class FrameArena final
+{
+public:
+    explicit FrameArena(size_t capacity = 32 * 1024 * 1024);
+    ~FrameArena();
+
+    DEL_ROF(FrameArena)
+
+    //Workers
+    [[nodiscard]] void* Allocate(size_t size, size_t alignment);
+
+    template <typename T>
+    [[nodiscard]] T* Allocate(const size_t count)
+    {
+        static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>, "Arena memory is never destructed");
+        return static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    //Releases every allocation in O(1), a frame that overflowed grows the arena so the next frames fit in a single block again
+    void Reset();
+
+    //Getters
+    [[nodiscard]] constexpr auto GetUsedBytes() const noexcept -> size_t { return m_UsedBytes; }
+    [[nodiscard]] constexpr auto GetCapacity() const noexcept -> size_t { return m_Capacity; }
+
+private:
+    std::byte* m_pBlock;
+    size_t m_Capacity;
+    size_t m_Offset;
+    size_t m_UsedBytes;
+
+    //Fallback blocks for a frame that did not fit, released and merged into a bigger block by Reset
+    std::vector<std::byte*> m_OverflowBlocks;
+};
+
+//Growable array living in a FrameArena, growing copies to a new arena allocation and leaves the old one until the arena resets
+template <typename T>
+class ArenaVector final
+{
+public:
+    static_assert(std::is_trivially_copyable_v<T>, "ArenaVector grows with a memcpy");
+
+    //Drops the contents, must be called after the arena was reset since the old storage is gone
+    void Reset(FrameArena* pArena) noexcept
+    {
+        m_pArena = pArena;
+        m_pData = nullptr;
+        m_Size = 0;
+        m_Capacity = 0;
+    }
+
+    void Reserve(const uint32_t capacity)
+    {
+        if (capacity <= m_Capacity)
+            return;
+
+        auto* pData = m_pArena->Allocate<T>(capacity);
+        if (m_Size > 0)
+            std::memcpy(pData, m_pData, sizeof(T) * m_Size);
+        m_pData = pData;
+        m_Capacity = capacity;
+    }
+
+    void PushBack(const T& value)
+    {
+        if (m_Size == m_Capacity)
+            Reserve(m_Capacity == 0 ? 16 : m_Capacity * 2);
+        m_pData[m_Size++] = value;
+    }
+
+    [[nodiscard]] T& operator[](const uint32_t idx) noexcept { return m_pData[idx]; }
+    [[nodiscard]] const T& operator[](const uint32_t idx) const noexcept { return m_pData[idx]; }
+    [[nodiscard]] T* begin() noexcept { return m_pData; }
+    [[nodiscard]] T* end() noexcept { return m_pData + m_Size; }
+    [[nodiscard]] const T* begin() const noexcept { return m_pData; }
+    [[nodiscard]] const T* end() const noexcept { return m_pData + m_Size; }
+    [[nodiscard]] constexpr auto GetSize() const noexcept -> uint32_t { return m_Size; }
+
+private:
+    FrameArena* m_pArena = nullptr;
+    T* m_pData = nullptr;
+    uint32_t m_Size = 0;
+    uint32_t m_Capacity = 0;
+};
+
+#endif // !FRAME_ARENA_HPP
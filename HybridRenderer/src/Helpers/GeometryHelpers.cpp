@@ -1,35 +1,172 @@
 ﻿#include "pch.h"
 #include "Helpers/GeometryHelpers.hpp"
 
-#include "GeneralHelpers.hpp"
-#include "Vertex.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
 
-void bgh::CalculateWeightArea(const glm::vec2& pixelPoint, const VertexOutput& v0, const VertexOutput& v1, const VertexOutput& v2, TriangleResult& triResult) noexcept
+glm::vec2 bgh::SnapToSubPixel(const glm::vec2& p) noexcept
 {
-    //Is point in triangle
-    const auto edgeA = glm::vec2(v1.pos) - glm::vec2(v0.pos);
-    auto pointToSide = pixelPoint - glm::vec2(v0.pos);
-    const auto signedAreaTriV2 = bme::Cross2D(pointToSide, edgeA);
-
-    const auto edgeB = glm::vec2(v2.pos) - glm::vec2(v1.pos);
-    pointToSide = pixelPoint - glm::vec2(v1.pos);
-    const auto signedAreaTriV0 = bme::Cross2D(pointToSide, edgeB);
-
-    const auto edgeC = glm::vec2(v0.pos) - glm::vec2(v2.pos);
-    pointToSide = pixelPoint - glm::vec2(v2.pos);
-    const auto signedAreaTriV1 = bme::Cross2D(pointToSide, edgeC);
-
-    triResult.weight0 = signedAreaTriV0;
-    triResult.weight1 = signedAreaTriV1;
-    triResult.weight2 = signedAreaTriV2;
-    triResult.Normalize();
+    // Rounds half away from zero like the lround in SetupTriangleEdges, scaling by a power of two keeps it exact
+    return glm::round(p * static_cast<float>(SubPixelScale)) / static_cast<float>(SubPixelScale);
 }
 
-bool bgh::IsPointInTriangle(const TriangleResult& triResult) noexcept
+bool bgh::SetupTriangleEdges(const glm::vec2& p0, const glm::vec2& p1, const glm::vec2& p2, TriangleEdges& triEdges) noexcept
 {
-    if (triResult.weight0 < 0 ||
-        triResult.weight1 < 0 ||
-        triResult.weight2 < 0)
-            return false;
+    // Snap to the sub-pixel grid
+    const std::array<glm::i64vec2, 3> vertices
+    {
+        glm::i64vec2(std::lround(p0.x * SubPixelScale), std::lround(p0.y * SubPixelScale)),
+        glm::i64vec2(std::lround(p1.x * SubPixelScale), std::lround(p1.y * SubPixelScale)),
+        glm::i64vec2(std::lround(p2.x * SubPixelScale), std::lround(p2.y * SubPixelScale))
+    };
+
+    const auto area =
+        (vertices[1].x - vertices[0].x) * (vertices[2].y - vertices[0].y) -
+        (vertices[1].y - vertices[0].y) * (vertices[2].x - vertices[0].x);
+
+    if (area == 0)
+        return false;
+
+    // Flip the edges of clockwise triangles, so the inside is always positive
+    const int64_t orientation = area > 0 ? 1 : -1;
+
+    for (auto k = 0; k < 3; ++k)
+    {
+        const auto& vI = vertices[(k + 1) % 3];
+        const auto& vJ = vertices[(k + 2) % 3];
+
+        const auto a = -(vJ.y - vI.y) * orientation;
+        const auto b = (vJ.x - vI.x) * orientation;
+        auto c = ((vJ.y - vI.y) * vI.x - (vJ.x - vI.x) * vI.y) * orientation;
+
+        // Top-left fill rule: pixels exactly on an edge only belong to the triangle if that edge is a left or top edge (y points down)
+        const auto isTopLeft = a > 0 || (a == 0 && b > 0);
+
+        // Sample at pixel centers and fold the fill rule bias in
+        c += (a + b) * (SubPixelScale / 2) + (isTopLeft ? 0 : -1);
+
+        // Stepping a whole pixel always moves the value by a multiple of SubPixelScale, so dropping the fraction (floor) keeps the sign test exact
+        triEdges.edges[k].a = static_cast<int32_t>(a);
+        triEdges.edges[k].b = static_cast<int32_t>(b);
+        triEdges.edges[k].c = c >> SubPixelBits;
+
+        // Samples are on the sub-pixel grid too, so their constant terms are floored the same way and stay exact
+        for (uint32_t s = 0; s < SampleCount; ++s)
+        {
+            const auto offset = glm::i64vec2(SamplePositions[s]) * static_cast<int64_t>(SubPixelScale / 16);
+            triEdges.sampleOffsets[s][k] = static_cast<int32_t>(((c + a * offset.x + b * offset.y) >> SubPixelBits) - triEdges.edges[k].c);
+        }
+    }
+
+    const auto minPoint = glm::min(vertices[0], glm::min(vertices[1], vertices[2]));
+    const auto maxPoint = glm::max(vertices[0], glm::max(vertices[1], vertices[2]));
+    constexpr auto halfPixel = SubPixelScale / 2;
+    triEdges.minX = static_cast<int32_t>((minPoint.x - halfPixel + SubPixelScale - 1) >> SubPixelBits);
+    triEdges.minY = static_cast<int32_t>((minPoint.y - halfPixel + SubPixelScale - 1) >> SubPixelBits);
+    triEdges.maxX = static_cast<int32_t>((maxPoint.x - halfPixel) >> SubPixelBits);
+    triEdges.maxY = static_cast<int32_t>((maxPoint.y - halfPixel) >> SubPixelBits);
+
+    constexpr auto sampleReach = SampleReach * (SubPixelScale / 16);
+    triEdges.sampleMinX = static_cast<int32_t>((minPoint.x - halfPixel - sampleReach + SubPixelScale - 1) >> SubPixelBits);
+    triEdges.sampleMinY = static_cast<int32_t>((minPoint.y - halfPixel - sampleReach + SubPixelScale - 1) >> SubPixelBits);
+    triEdges.sampleMaxX = static_cast<int32_t>((maxPoint.x - halfPixel + sampleReach) >> SubPixelBits);
+    triEdges.sampleMaxY = static_cast<int32_t>((maxPoint.y - halfPixel + sampleReach) >> SubPixelBits);
     return true;
-}
\ No newline at end of file
+}
+
+uint32_t bgh::CalculateClipCodes(const glm::vec4& clipPos) noexcept
+{
+    const auto guardW = GuardBand * clipPos.w;
+
+    uint32_t clipCodes = ClipNone;
+    clipCodes |= clipPos.z < NearClipEpsilon * clipPos.w ? ClipNear : ClipNone;
+    clipCodes |= clipPos.z > clipPos.w ? ClipFar : ClipNone;
+    clipCodes |= clipPos.x < -clipPos.w ? ClipLeft : ClipNone;
+    clipCodes |= clipPos.x > clipPos.w ? ClipRight : ClipNone;
+    clipCodes |= clipPos.y < -clipPos.w ? ClipBottom : ClipNone;
+    clipCodes |= clipPos.y > clipPos.w ? ClipTop : ClipNone;
+    clipCodes |= clipPos.x < -guardW ? ClipGuardLeft : ClipNone;
+    clipCodes |= clipPos.x > guardW ? ClipGuardRight : ClipNone;
+    clipCodes |= clipPos.y < -guardW ? ClipGuardBottom : ClipNone;
+    clipCodes |= clipPos.y > guardW ? ClipGuardTop : ClipNone;
+    return clipCodes;
+}
+
+glm::vec4 bgh::ClipToScreen(const glm::vec4& clipPos, const float width, const float height) noexcept
+{
+    const auto invW = 1.f / clipPos.w;
+    return {(clipPos.x * invW + 1) / 2 * width, (1 - clipPos.y * invW) / 2 * height, clipPos.z * invW, clipPos.w};
+}
+
+glm::vec4 bgh::ScreenToClip(const glm::vec4& screenPos, const float width, const float height) noexcept
+{
+    const auto w = screenPos.w;
+    return {(screenPos.x / width * 2 - 1) * w, (1 - screenPos.y / height * 2) * w, screenPos.z * w, w};
+}
+
+uint32_t bgh::ClipTriangle(VertexOutput (&polygon)[MaxClippedVertices], const uint32_t clipCodes) noexcept
+{
+    // Signed distance to each plane we can clip against, positive is inside
+    struct ClipPlane
+    {
+        ClipCode code;
+        glm::vec4 plane;
+    };
+    constexpr ClipPlane clipPlanes[]
+    {
+        {ClipNear, {0.f, 0.f, 1.f, -NearClipEpsilon}},
+        {ClipFar, {0.f, 0.f, -1.f, 1.f}},
+        {ClipGuardLeft, {1.f, 0.f, 0.f, GuardBand}},
+        {ClipGuardRight, {-1.f, 0.f, 0.f, GuardBand}},
+        {ClipGuardBottom, {0.f, 1.f, 0.f, GuardBand}},
+        {ClipGuardTop, {0.f, -1.f, 0.f, GuardBand}}
+    };
+
+    const auto lerpVertex = [](const VertexOutput& a, const VertexOutput& b, const float t)
+    {
+        // Every attribute is linear in clip space, so a plain lerp along the edge is exact
+        VertexOutput v{};
+        v.pos = glm::mix(a.pos, b.pos, t);
+        v.worldPos = glm::mix(a.worldPos, b.worldPos, t);
+        v.uv = glm::mix(a.uv, b.uv, t);
+        v.normal = glm::mix(a.normal, b.normal, t);
+        v.tangent = glm::mix(a.tangent, b.tangent, t);
+        v.viewDirection = glm::mix(a.viewDirection, b.viewDirection, t);
+        return v;
+    };
+
+    VertexOutput scratch[MaxClippedVertices];
+    auto* pIn = polygon;
+    auto* pOut = scratch;
+    uint32_t count = 3;
+
+    for (const auto& [code, plane] : clipPlanes)
+    {
+        if ((clipCodes & code) == 0)
+            continue;
+
+        uint32_t outCount = 0;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const auto& current = pIn[i];
+            const auto& next = pIn[(i + 1) % count];
+            const auto currentDist = glm::dot(plane, current.pos);
+            const auto nextDist = glm::dot(plane, next.pos);
+
+            if (currentDist >= 0.f)
+                pOut[outCount++] = current;
+            if ((currentDist >= 0.f) != (nextDist >= 0.f))
+                pOut[outCount++] = lerpVertex(current, next, currentDist / (currentDist - nextDist));
+        }
+
+        std::swap(pIn, pOut);
+        count = outCount;
+        if (count < 3)
+            return 0;
+    }
+
+    if (pIn != polygon)
+        std::copy_n(pIn, count, polygon);
+    return count;
+}
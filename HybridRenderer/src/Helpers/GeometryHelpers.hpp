@@ -1,15 +1,106 @@
 ﻿#ifndef GEOMETRY_HELPERS_HPP
 #define GEOMETRY_HELPERS_HPP
+#include <cstdint>
 #include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
 
-struct TriangleResult;
-struct VertexOutput;
+#include "Helpers/Vertex.hpp"
 
 namespace bgh
 {
-    void CalculateWeightArea(const glm::vec2& pixelPoint, const VertexOutput& v0, const VertexOutput& v1, const VertexOutput& v2, TriangleResult& triResult) noexcept;
-    [[nodiscard]] auto IsPointInTriangle(const TriangleResult& triResult) noexcept -> bool;
+    //Rasterization runs on a 28.4 fixed point grid
+    constexpr int32_t SubPixelBits = 4;
+    constexpr int32_t SubPixelScale = 1 << SubPixelBits;
+
+    //Standard 4x rotated grid, sample positions relative to the pixel center in 1/16th of a pixel
+    constexpr uint32_t SampleCount = 4;
+    constexpr glm::ivec2 SamplePositions[SampleCount]{{-2, -6}, {6, -2}, {-6, 2}, {2, 6}};
+    constexpr int32_t SampleReach = 6; // farthest a sample sits from the center on either axis
+    static_assert(SubPixelScale % 16 == 0, "Sample positions have to land on the sub-pixel grid");
+
+    //Edge function in pixel steps, sampled at pixel centers, with the top-left fill rule baked into the constant term.
+    //A pixel is covered by the edge when its value is >= 0. Values fit in 32 bits for viewports up to MaxViewportSize.
+    struct EdgeFunction
+    {
+        int32_t a; // step per pixel in x
+        int32_t b; // step per pixel in y
+        int64_t c;
+
+        [[nodiscard]] constexpr auto Evaluate(const int32_t x, const int32_t y) const noexcept -> int32_t
+        {
+            return static_cast<int32_t>(a * static_cast<int64_t>(x) + b * static_cast<int64_t>(y) + c);
+        }
+    };
+
+    struct TriangleEdges
+    {
+        EdgeFunction edges[3]; // edges[i] lies opposite of vertex i, so its value is the unnormalized weight of vertex i
+        int32_t minX;          // pixel bounds (inclusive) of the pixel centers the triangle can cover
+        int32_t minY;
+        int32_t maxX;
+        int32_t maxY;
+
+        /*Multisampling*/
+        glm::ivec3 sampleOffsets[SampleCount]; // added to the pixel center values of all three edges this gives the exact values at each sample
+        int32_t sampleMinX;                     // pixel bounds (inclusive) of the pixels whose samples the triangle can cover
+        int32_t sampleMinY;
+        int32_t sampleMaxX;
+        int32_t sampleMaxY;
+    };
+
+    //Position snapped to the sub-pixel grid the rasterizer works on, in pixels
+    [[nodiscard]] auto SnapToSubPixel(const glm::vec2& p) noexcept -> glm::vec2;
+
+    /**
+     * Snaps the triangle to the sub-pixel grid and sets up its edge functions, independent of winding
+     * @return false if the snapped triangle has no area
+     * */
+    [[nodiscard]] auto SetupTriangleEdges(const glm::vec2& p0, const glm::vec2& p1, const glm::vec2& p2, TriangleEdges& triEdges) noexcept -> bool;
+
+    //Clip codes of a clip space position, a set bit means the position is outside of that plane
+    enum ClipCode : uint32_t
+    {
+        ClipNone = 0,
+        ClipNear = 1 << 0,
+        ClipFar = 1 << 1,
+        ClipLeft = 1 << 2,
+        ClipRight = 1 << 3,
+        ClipBottom = 1 << 4,
+        ClipTop = 1 << 5,
+        ClipGuardLeft = 1 << 6,
+        ClipGuardRight = 1 << 7,
+        ClipGuardBottom = 1 << 8,
+        ClipGuardTop = 1 << 9,
+
+        ClipFrustum = ClipNear | ClipFar | ClipLeft | ClipRight | ClipBottom | ClipTop,
+        //Only these planes are actually clipped against, the sides of the frustum are left to the rasterizer
+        ClipRequired = ClipNear | ClipFar | ClipGuardLeft | ClipGuardRight | ClipGuardBottom | ClipGuardTop
+    };
+
+    //The guard band spans twice the viewport in NDC, which keeps snapped coordinates well inside the rasterizer's fixed point range
+    constexpr float GuardBand = 2.f;
+    //Largest viewport width or height. Inside a triangle's bounds an edge value stays below SubPixelScale times the bounds' area,
+    //at most (GuardBand * MaxViewportSize)^2 pixels, and it is stepped in 32 bits. Half the range is left for spans reaching past the bounds
+    constexpr uint32_t MaxViewportSize = 4096;
+    static_assert(SubPixelScale * (GuardBand * MaxViewportSize) * (GuardBand * MaxViewportSize) <= 1073741824.f, "Edge values of the largest viewport have to fit in 31 bits with room to spare");
+    //Clipping slightly in front of the near plane keeps the interpolated 1/z finite
+    constexpr float NearClipEpsilon = 1e-5f;
+    //A triangle clipped against all 6 clip planes has at most 9 vertices
+    constexpr uint32_t MaxClippedVertices = 9;
+
+    [[nodiscard]] auto CalculateClipCodes(const glm::vec4& clipPos) noexcept -> uint32_t;
+
+    //Perspective divide followed by the viewport transform, w is kept for perspective correct interpolation
+    [[nodiscard]] auto ClipToScreen(const glm::vec4& clipPos, float width, float height) noexcept -> glm::vec4;
+    [[nodiscard]] auto ScreenToClip(const glm::vec4& screenPos, float width, float height) noexcept -> glm::vec4;
+
+    /**
+     * Clips a triangle in clip space against the planes in clipCodes (Sutherland-Hodgman), the result is a convex polygon with the same winding
+     * @param polygon holds the triangle on input and the clipped polygon on output
+     * @return amount of vertices in polygon, less than 3 when nothing is left
+     * */
+    [[nodiscard]] auto ClipTriangle(VertexOutput (&polygon)[MaxClippedVertices], uint32_t clipCodes) noexcept -> uint32_t;
 }
 
 
-#endif // !GEOMETRY_HELPERS_HPP
\ No newline at end of file
+#endif // !GEOMETRY_HELPERS_HPP
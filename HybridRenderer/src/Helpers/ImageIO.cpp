@@ -0,0 +1,96 @@
+#include "pch.h"
+#include "Helpers/ImageIO.hpp"
+
+#include <cstring>
+
+#ifdef HYBRID_HEADLESS
+#include <png.h>
+#else
+#include <SDL_image.h>
+#endif
+
+#include "Debugging/Logger.hpp"
+
+#ifdef HYBRID_HEADLESS
+bool ImageIO::Load(const std::string& filePath, Image& image)
+{
+    // libpng's simplified API converts any PNG to the requested layout, RGBA bytes are RGBA8 with red in the low byte
+    png_image png{};
+    png.version = PNG_IMAGE_VERSION;
+    if (!png_image_begin_read_from_file(&png, filePath.c_str()))
+    {
+        LOG(LEVEL_ERROR, "Failed to load image " << filePath << ": " << png.message)
+        return false;
+    }
+
+    png.format = PNG_FORMAT_RGBA;
+    image.width = png.width;
+    image.height = png.height;
+    image.texels.resize(static_cast<size_t>(png.width) * png.height);
+    if (!png_image_finish_read(&png, nullptr, image.texels.data(), 0, nullptr))
+    {
+        LOG(LEVEL_ERROR, "Failed to decode image " << filePath << ": " << png.message)
+        image = {};
+        return false;
+    }
+    return true;
+}
+
+bool ImageIO::SavePNG(const std::string& filePath, const Image& image)
+{
+    png_image png{};
+    png.version = PNG_IMAGE_VERSION;
+    png.width = image.width;
+    png.height = image.height;
+    png.format = PNG_FORMAT_RGBA;
+    if (!png_image_write_to_file(&png, filePath.c_str(), 0, image.texels.data(), 0, nullptr))
+    {
+        LOG(LEVEL_ERROR, "Failed to write image " << filePath << ": " << png.message)
+        return false;
+    }
+    return true;
+}
+#else
+bool ImageIO::Load(const std::string& filePath, Image& image)
+{
+    auto* pLoadedSurface = IMG_Load(filePath.c_str());
+    if (pLoadedSurface == nullptr)
+    {
+        LOG(LEVEL_ERROR, "Failed to load image " << filePath << ": " << IMG_GetError())
+        return false;
+    }
+
+    // SDL's RGBA32 is RGBA in byte order whatever the endianness, so red ends up in the low byte
+    auto* pSurface = SDL_ConvertSurfaceFormat(pLoadedSurface, SDL_PIXELFORMAT_RGBA32, 0);
+    SDL_FreeSurface(pLoadedSurface);
+    if (pSurface == nullptr)
+    {
+        LOG(LEVEL_ERROR, "Failed to convert image " << filePath << ": " << SDL_GetError())
+        return false;
+    }
+
+    image.width = static_cast<uint32_t>(pSurface->w);
+    image.height = static_cast<uint32_t>(pSurface->h);
+    image.texels.resize(static_cast<size_t>(image.width) * image.height);
+    for (uint32_t y = 0; y < image.height; ++y)
+    {
+        std::memcpy(&image.texels[y * image.width], static_cast<const uint8_t*>(pSurface->pixels) + y * pSurface->pitch, image.width * sizeof(uint32_t));
+    }
+    SDL_FreeSurface(pSurface);
+    return true;
+}
+
+bool ImageIO::SavePNG(const std::string& filePath, const Image& image)
+{
+    auto* pSurface = SDL_CreateRGBSurfaceWithFormatFrom(const_cast<uint32_t*>(image.texels.data()), static_cast<int>(image.width), static_cast<int>(image.height),
+        32, static_cast<int>(image.width * sizeof(uint32_t)), SDL_PIXELFORMAT_RGBA32);
+    if (pSurface == nullptr || IMG_SavePNG(pSurface, filePath.c_str()) != 0)
+    {
+        LOG(LEVEL_ERROR, "Failed to write image " << filePath << ": " << SDL_GetError())
+        SDL_FreeSurface(pSurface);
+        return false;
+    }
+    SDL_FreeSurface(pSurface);
+    return true;
+}
+#endif
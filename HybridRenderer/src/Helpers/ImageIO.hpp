@@ -0,0 +1,25 @@
+#ifndef IMAGE_IO_HPP
+#define IMAGE_IO_HPP
+
+//Standard includes
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//Reads and writes image files, through SDL_image in the windowed build and libpng in the headless one
+namespace ImageIO
+{
+    //RGBA8, red in the low byte of every texel, rows tightly packed
+    struct Image
+    {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        std::vector<uint32_t> texels;
+    };
+
+    //Decodes the file to RGBA8, logs and returns false when it can't be read
+    [[nodiscard]] bool Load(const std::string& filePath, Image& image);
+    bool SavePNG(const std::string& filePath, const Image& image);
+}
+
+#endif // !IMAGE_IO_HPP
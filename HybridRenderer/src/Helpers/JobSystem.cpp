@@ -0,0 +1,246 @@
+#include "pch.h"
+#include "Helpers/JobSystem.hpp"
+
+thread_local uint32_t JobSystem::s_ThreadIdx = JobSystem::InvalidThread;
+
+JobSystem::JobSystem(Token)
+    : m_ThreadCount(0),
+      m_pQueues(nullptr),
+      m_QueuedJobs(0),
+      m_SleepingThreads(0),
+      m_IsStopping(false)
+{
+    Configure(0);
+}
+
+JobSystem::~JobSystem()
+{
+    StopWorkers();
+    delete[] m_pQueues;
+}
+
+#pragma region Workers
+void JobSystem::Wait(const JobCounter& counter)
+{
+    // Threads outside of the system can't run jobs, a job may have to split and they have no pool to split into
+    if (!IsJobThread())
+    {
+        while (!counter.IsDone())
+            std::this_thread::yield();
+        return;
+    }
+
+    while (!counter.IsDone())
+    {
+        if (auto* pJob = FindJob(s_ThreadIdx))
+            RunJob(*pJob);
+        else
+            std::this_thread::yield(); // the last jobs of the group are running on other threads
+    }
+}
+
+Job& JobSystem::AllocateJob()
+{
+    auto& queue = m_pQueues[s_ThreadIdx];
+    while (true)
+    {
+        // Jobs finish roughly in the order they were allocated, so the next slot is almost always free
+        for (uint32_t attempt = 0; attempt < PoolCapacity; ++attempt)
+        {
+            auto& job = queue.pool[queue.nextPoolJob];
+            queue.nextPoolJob = (queue.nextPoolJob + 1) % PoolCapacity;
+            if (!job.isInUse.load(std::memory_order_acquire))
+            {
+                job.isInUse.store(true, std::memory_order_relaxed);
+                job.pNextWaiting = nullptr;
+                return job;
+            }
+        }
+
+        // Every job of this thread is still in flight, help finish some
+        if (auto* pJob = FindJob(s_ThreadIdx))
+            RunJob(*pJob);
+        else
+            std::this_thread::yield();
+    }
+}
+
+void JobSystem::Submit(Job& job, JobCounter& counter, JobCounter* pDependency)
+{
+    counter.m_Pending.fetch_add(1);
+    job.pCounter = &counter;
+
+    // The job that finishes the dependency takes its waiting list under the same lock, so a job is either linked before that or sees it done
+    if (pDependency != nullptr)
+    {
+        std::lock_guard lock(pDependency->m_Mutex);
+        if (pDependency->m_Pending.load() != 0)
+        {
+            job.pNextWaiting = pDependency->m_pWaiting;
+            pDependency->m_pWaiting = &job;
+            return;
+        }
+    }
+
+    Push(job);
+}
+
+void JobSystem::Push(Job& job)
+{
+    auto& queue = m_pQueues[s_ThreadIdx];
+    {
+        std::unique_lock lock(queue.mutex);
+        if (queue.tail - queue.head == QueueCapacity)
+        {
+            // No room to share it, so run it right here
+            lock.unlock();
+            RunJob(job);
+            return;
+        }
+        queue.pJobs[queue.tail++ % QueueCapacity] = &job;
+        m_QueuedJobs.fetch_add(1);
+    }
+
+    // Sleeping threads check the queued count under the sleep lock, taking it here makes sure the notify can't slip in between
+    if (m_SleepingThreads.load() > 0)
+    {
+        std::lock_guard lock(m_SleepMutex);
+        m_WakeCondition.notify_one();
+    }
+}
+
+Job* JobSystem::FindJob(const uint32_t threadIdx)
+{
+    // Newest own job first, it's the smallest piece and its data is still in cache
+    {
+        auto& queue = m_pQueues[threadIdx];
+        std::lock_guard lock(queue.mutex);
+        if (queue.tail != queue.head)
+        {
+            m_QueuedJobs.fetch_sub(1);
+            return queue.pJobs[--queue.tail % QueueCapacity];
+        }
+    }
+
+    // Steal the oldest job of another thread, for a parallel for that's the biggest range left
+    for (uint32_t offset = 1; offset < m_ThreadCount; ++offset)
+    {
+        auto& queue = m_pQueues[(threadIdx + offset) % m_ThreadCount];
+        std::lock_guard lock(queue.mutex);
+        if (queue.tail != queue.head)
+        {
+            m_QueuedJobs.fetch_sub(1);
+            return queue.pJobs[queue.head++ % QueueCapacity];
+        }
+    }
+    return nullptr;
+}
+
+void JobSystem::RunJob(Job& job)
+{
+    // Split off the upper half until the range is small enough, it stays in reach of thieves while this thread works on the lower half
+    while (job.end - job.begin > job.grainSize)
+    {
+        const auto middle = job.begin + (job.end - job.begin) / 2;
+
+        auto& upperHalf = AllocateJob();
+        std::memcpy(upperHalf.data, job.data, Job::DataSize);
+        upperHalf.pFunction = job.pFunction;
+        upperHalf.begin = middle;
+        upperHalf.end = job.end;
+        upperHalf.grainSize = job.grainSize;
+        Submit(upperHalf, *job.pCounter, nullptr);
+
+        job.end = middle;
+    }
+
+    job.pFunction(job.data, job.begin, job.end);
+    Finish(job);
+}
+
+void JobSystem::Finish(Job& job)
+{
+    auto& counter = *job.pCounter;
+    job.isInUse.store(false, std::memory_order_release);
+
+    // Once pending hits zero a waiter may return and destroy the counter, signalling keeps it from doing so until the waiting jobs are out
+    counter.m_Signalling.fetch_add(1);
+    if (counter.m_Pending.fetch_sub(1) == 1)
+    {
+        Job* pWaiting;
+        {
+            std::lock_guard lock(counter.m_Mutex);
+            pWaiting = counter.m_pWaiting;
+            counter.m_pWaiting = nullptr;
+        }
+
+        while (pWaiting != nullptr)
+        {
+            auto* pNext = pWaiting->pNextWaiting;
+            Push(*pWaiting);
+            pWaiting = pNext;
+        }
+    }
+    counter.m_Signalling.fetch_sub(1);
+}
+
+void JobSystem::WorkerLoop(const uint32_t threadIdx)
+{
+    s_ThreadIdx = threadIdx;
+    while (true)
+    {
+        if (auto* pJob = FindJob(threadIdx))
+        {
+            RunJob(*pJob);
+            continue;
+        }
+
+        std::unique_lock lock(m_SleepMutex);
+        m_SleepingThreads.fetch_add(1);
+        m_WakeCondition.wait(lock, [this]() { return m_IsStopping || m_QueuedJobs.load() > 0; });
+        m_SleepingThreads.fetch_sub(1);
+        if (m_IsStopping)
+            return;
+    }
+}
+
+void JobSystem::StopWorkers()
+{
+    {
+        std::lock_guard lock(m_SleepMutex);
+        m_IsStopping = true;
+    }
+    m_WakeCondition.notify_all();
+
+    for (auto& worker : m_Workers)
+    {
+        worker.join();
+    }
+    m_Workers.clear();
+    m_IsStopping = false;
+}
+#pragma endregion
+
+#pragma region Setters
+void JobSystem::Configure(const uint32_t threadCount)
+{
+    const auto totalThreads = threadCount == 0 ? std::max(1u, std::thread::hardware_concurrency()) : threadCount;
+    s_ThreadIdx = 0;
+    if (totalThreads == m_ThreadCount)
+        return;
+
+    StopWorkers();
+    delete[] m_pQueues;
+
+    m_ThreadCount = totalThreads;
+    m_pQueues = new ThreadQueue[m_ThreadCount];
+    m_QueuedJobs.store(0);
+
+    // The configuring thread is thread 0, it runs jobs whenever it waits so it does not need a worker of its own
+    m_Workers.reserve(m_ThreadCount - 1);
+    for (uint32_t i = 1; i < m_ThreadCount; ++i)
+    {
+        m_Workers.emplace_back(&JobSystem::WorkerLoop, this, i);
+    }
+}
+#pragma endregion
@@ -0,0 +1,194 @@
+#ifndef JOB_SYSTEM_HPP
+#define JOB_SYSTEM_HPP
+
+//Standard includes
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+//Project includes
+#include "Helpers/Singleton.hpp"
+
+struct Job;
+
+//Tracks a group of scheduled jobs, it is done once every one of them ran.
+//Jobs can depend on a counter, they are only queued once it is done, chaining counters like that builds a task graph.
+//Always wait on a counter before it goes out of scope, the job that finished it may still be touching it.
+class JobCounter final
+{
+public:
+    JobCounter() = default;
+    ~JobCounter() = default;
+    DEL_ROF(JobCounter)
+
+    //Getters
+    [[nodiscard]] auto IsDone() const noexcept -> bool
+    {
+        // The job that finished the group may still be queueing the jobs that waited on it
+        return m_Pending.load() == 0 && m_Signalling.load() == 0;
+    }
+
+private:
+    friend class JobSystem;
+
+    std::atomic<uint32_t> m_Pending{0};
+    std::atomic<uint32_t> m_Signalling{0};
+    std::mutex m_Mutex;         // guards m_pWaiting
+    Job* m_pWaiting = nullptr; // jobs depending on this counter, linked through Job::pNextWaiting
+};
+
+//A scheduled task or range of a parallel for, jobs live in fixed pools per thread so scheduling never allocates
+struct Job
+{
+    static constexpr size_t DataSize = 48;
+    using Function = void (*)(const void* pData, uint32_t begin, uint32_t end);
+
+    alignas(std::max_align_t) std::byte data[DataSize]; // copy of the task
+    Function pFunction = nullptr;
+    uint32_t begin = 0;     // range of indices to run, [0, 1[ for a single task
+    uint32_t end = 0;
+    uint32_t grainSize = 1; // ranges are split in halves until they are this small
+    JobCounter* pCounter = nullptr;
+    Job* pNextWaiting = nullptr;
+    std::atomic<bool> isInUse{false};
+};
+
+//Work stealing scheduler, every parallel part of the engine runs on it.
+//Every thread owns a deque, it pushes and pops jobs at the back while idle threads steal from the front.
+//Parallel fors split their range in halves as they run, so a thief always takes the biggest piece that is left.
+//The thread that configured the system is thread 0, it has no worker of its own and runs jobs while it waits.
+//With a single thread every job runs inside Wait on the calling thread, in a fixed order, which makes debugging a lot easier.
+class JobSystem final : public Singleton<JobSystem>
+{
+public:
+    explicit JobSystem(Token);
+    ~JobSystem();
+    DEL_ROF(JobSystem)
+
+    //Workers
+    /**
+     * Queues task(), the task is copied into the job so it has to be small and trivially copyable.
+     * Whatever it captures by reference has to outlive the counter.
+     * @param counter incremented right away, decremented once the task ran
+     * @param pDependency the task is only queued once this counter is done
+     * */
+    template <typename Task>
+    void Schedule(const Task& task, JobCounter& counter, JobCounter* pDependency = nullptr)
+    {
+        ScheduleFor(1, [task](uint32_t) { task(); }, counter, pDependency);
+    }
+
+    /**
+     * Queues task(i) for every i in [0, count[, same rules as Schedule
+     * @param grainSize smallest range a single job runs, raised when count is big so every thread gets a few pieces to steal
+     * */
+    template <typename Task>
+    void ScheduleFor(const uint32_t count, const Task& task, JobCounter& counter, JobCounter* pDependency = nullptr, const uint32_t grainSize = 1)
+    {
+        static_assert(sizeof(Task) <= Job::DataSize && alignof(Task) <= alignof(std::max_align_t), "Tasks are stored in their job, capture less or capture by reference");
+        static_assert(std::is_trivially_copy_constructible_v<Task> && std::is_trivially_destructible_v<Task>, "Jobs are copied as raw bytes when a range is split");
+
+        if (count == 0)
+            return;
+
+        // Threads outside of the system have no job pool, they run the work themselves
+        if (!IsJobThread())
+        {
+            if (pDependency != nullptr)
+                Wait(*pDependency);
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                task(i);
+            }
+            return;
+        }
+
+        auto& job = AllocateJob();
+        new (job.data) Task(task);
+        job.pFunction = [](const void* pData, const uint32_t begin, const uint32_t end)
+        {
+            const auto& storedTask = *std::launder(static_cast<const Task*>(pData));
+            for (auto i = begin; i < end; ++i)
+            {
+                storedTask(i);
+            }
+        };
+        job.begin = 0;
+        job.end = count;
+        job.grainSize = std::max({1u, grainSize, count / (GetThreadCount() * MaxRangesPerThread)});
+        Submit(job, counter, pDependency);
+    }
+
+    /**
+     * Runs task(i) for every i in [0, count[ and returns once all of them ran, the calling thread helps out.
+     * The task is only referenced, so it can capture anything.
+     * */
+    template <typename Task>
+    void ParallelFor(const uint32_t count, const Task& task, const uint32_t grainSize = 1)
+    {
+        JobCounter counter;
+        ScheduleFor(count, [&task](const uint32_t idx) { task(idx); }, counter, nullptr, grainSize);
+        Wait(counter);
+    }
+
+    //Runs queued jobs on the calling thread until the counter is done
+    void Wait(const JobCounter& counter);
+
+    //Setters
+    //Restarts the workers from the calling thread, which becomes thread 0. Nothing may be queued while doing so (0 = hardware concurrency, 1 = single threaded)
+    void Configure(uint32_t threadCount);
+
+    //Getters
+    [[nodiscard]] constexpr auto GetThreadCount() const noexcept -> uint32_t { return m_ThreadCount; }
+
+private:
+    static constexpr uint32_t QueueCapacity = 1024;
+    static constexpr uint32_t PoolCapacity = 1024;
+    static constexpr uint32_t MaxRangesPerThread = 8;
+    static constexpr uint32_t InvalidThread = ~0u;
+
+    //Jobs a thread queued and the pool it allocates its jobs from
+    struct ThreadQueue
+    {
+        std::mutex mutex;
+        Job* pJobs[QueueCapacity]{};
+        uint32_t head = 0; // thieves take from the front
+        uint32_t tail = 0; // the owner pushes and pops at the back
+
+        Job pool[PoolCapacity];
+        uint32_t nextPoolJob = 0;
+    };
+
+    static thread_local uint32_t s_ThreadIdx;
+
+    uint32_t m_ThreadCount;
+    ThreadQueue* m_pQueues;
+    std::vector<std::thread> m_Workers;
+
+    std::atomic<uint32_t> m_QueuedJobs;
+    std::atomic<uint32_t> m_SleepingThreads;
+    std::mutex m_SleepMutex;
+    std::condition_variable m_WakeCondition;
+    bool m_IsStopping;
+
+    [[nodiscard]] static auto IsJobThread() noexcept -> bool { return s_ThreadIdx != InvalidThread; }
+
+    [[nodiscard]] Job& AllocateJob();
+    void Submit(Job& job, JobCounter& counter, JobCounter* pDependency);
+    void Push(Job& job);
+    [[nodiscard]] Job* FindJob(uint32_t threadIdx);
+    void RunJob(Job& job);
+    void Finish(Job& job);
+    void WorkerLoop(uint32_t threadIdx);
+    void StopWorkers();
+};
+
+#endif // !JOB_SYSTEM_HPP
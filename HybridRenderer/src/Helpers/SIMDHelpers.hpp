@@ -0,0 +1,360 @@
+#ifndef SIMD_HELPERS_HPP
+#define SIMD_HELPERS_HPP
+
+//Standard includes
+#include <algorithm>
+#include <cstdint>
+#include <immintrin.h>
+#include <limits>
+
+//Project includes
+#include "Helpers/MathHelpers.hpp"
+
+//8-wide span kernels for the software rasterizer.
+//Built with AVX2 (/arch:AVX2) a span is a single 256 bit register, otherwise it falls back to two SSE2 halves.
+namespace bsimd
+{
+    constexpr uint32_t SpanWidth = 8;
+
+    enum class DepthTest
+    {
+        Less,         //Passes when closer than the stored depth, the stored depth is replaced
+        Equal,        //Passes when matching a finite stored depth exactly, the depth buffer is left untouched
+        LessReadOnly  //Passes when closer than the stored depth, the depth buffer is left untouched (blended surfaces)
+    };
+
+    /**
+     * Tests coverage and depth for up to 8 consecutive pixels of a row and, for DepthTest::Less, writes the depth of every lane that passes.
+     * Both tests interpolate depth the exact same way, so an Equal pass finds back the depth a Less pass stored.
+     * Lanes whose interpolated depth is not finite fail every test, so an Equal pass never matches the cleared +inf either.
+     * @param edges edge function values at the first pixel of the span
+     * @param steps edge function steps per pixel in x
+     * @param depth depth at the first pixel of the span and its step per pixel in x, the edge values only decide coverage
+     * @param depthRange the interpolated depth is clamped to [x, y], the depth range of the triangle's vertices
+     * @param laneCount amount of valid pixels in the span [1, 8]
+     * @param pDepth depth buffer at the first pixel of the span, lanes outside laneCount are never touched
+     * @param depthOut interpolated depth of every lane
+     * @return bitmask of the lanes that are covered and passed the depth test
+     * */
+    template <DepthTest Test = DepthTest::Less>
+    [[nodiscard]] inline uint32_t DepthTestSpan(const glm::ivec3& edges, const glm::ivec3& steps, const glm::vec2& depth, const glm::vec2& depthRange,
+                                                const uint32_t laneCount, float* pDepth, float (&depthOut)[SpanWidth]) noexcept
+    {
+#if defined(__AVX2__)
+        const auto laneIdx = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        const auto e0 = _mm256_add_epi32(_mm256_set1_epi32(edges.x), _mm256_mullo_epi32(laneIdx, _mm256_set1_epi32(steps.x)));
+        const auto e1 = _mm256_add_epi32(_mm256_set1_epi32(edges.y), _mm256_mullo_epi32(laneIdx, _mm256_set1_epi32(steps.y)));
+        const auto e2 = _mm256_add_epi32(_mm256_set1_epi32(edges.z), _mm256_mullo_epi32(laneIdx, _mm256_set1_epi32(steps.z)));
+
+        // Covered when no edge has its sign bit set
+        const auto coverMask = _mm256_cmpgt_epi32(_mm256_or_si256(_mm256_or_si256(e0, e1), e2), _mm256_set1_epi32(-1));
+        const auto rangeMask = _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int32_t>(laneCount)), laneIdx);
+        auto liveMask = _mm256_and_si256(coverMask, rangeMask);
+        if (_mm256_testz_si256(liveMask, liveMask))
+            return 0;
+
+        // Checked before clamping, the clamp would turn NaN into the range's bound
+        auto laneDepth = _mm256_fmadd_ps(_mm256_cvtepi32_ps(laneIdx), _mm256_set1_ps(depth.y), _mm256_set1_ps(depth.x));
+        const auto finiteMask = _mm256_cmp_ps(_mm256_andnot_ps(_mm256_set1_ps(-0.f), laneDepth), _mm256_set1_ps(std::numeric_limits<float>::infinity()), _CMP_LT_OQ);
+        liveMask = _mm256_and_si256(liveMask, _mm256_castps_si256(finiteMask));
+        laneDepth = _mm256_min_ps(_mm256_max_ps(laneDepth, _mm256_set1_ps(depthRange.x)), _mm256_set1_ps(depthRange.y));
+
+        const auto storedDepth = _mm256_maskload_ps(pDepth, liveMask);
+        const auto compareMask = Test == DepthTest::Equal ? _mm256_cmp_ps(laneDepth, storedDepth, _CMP_EQ_OQ) : _mm256_cmp_ps(laneDepth, storedDepth, _CMP_LT_OQ);
+        const auto passMask = _mm256_and_si256(liveMask, _mm256_castps_si256(compareMask));
+
+        if constexpr (Test == DepthTest::Less)
+            _mm256_maskstore_ps(pDepth, passMask, laneDepth);
+        _mm256_storeu_ps(depthOut, laneDepth);
+        return static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(passMask)));
+#else
+        uint32_t passBits = 0;
+        for (uint32_t half = 0; half < SpanWidth; half += 4)
+        {
+            const auto lane = static_cast<int32_t>(half);
+            const auto e0 = _mm_setr_epi32(edges.x + steps.x * lane, edges.x + steps.x * (lane + 1), edges.x + steps.x * (lane + 2), edges.x + steps.x * (lane + 3));
+            const auto e1 = _mm_setr_epi32(edges.y + steps.y * lane, edges.y + steps.y * (lane + 1), edges.y + steps.y * (lane + 2), edges.y + steps.y * (lane + 3));
+            const auto e2 = _mm_setr_epi32(edges.z + steps.z * lane, edges.z + steps.z * (lane + 1), edges.z + steps.z * (lane + 2), edges.z + steps.z * (lane + 3));
+
+            // Covered when no edge has its sign bit set
+            const auto coverMask = _mm_cmpgt_epi32(_mm_or_si128(_mm_or_si128(e0, e1), e2), _mm_set1_epi32(-1));
+            const auto rangeMask = _mm_cmpgt_epi32(_mm_set1_epi32(static_cast<int32_t>(laneCount)), _mm_setr_epi32(lane, lane + 1, lane + 2, lane + 3));
+            if (_mm_movemask_epi8(_mm_and_si128(coverMask, rangeMask)) == 0)
+                continue;
+
+            // Checked before clamping, the clamp would turn NaN into the range's bound
+            auto laneDepth = _mm_add_ps(_mm_set1_ps(depth.x), _mm_mul_ps(_mm_cvtepi32_ps(_mm_setr_epi32(lane, lane + 1, lane + 2, lane + 3)), _mm_set1_ps(depth.y)));
+            const auto finiteMask = _mm_cmplt_ps(_mm_andnot_ps(_mm_set1_ps(-0.f), laneDepth), _mm_set1_ps(std::numeric_limits<float>::infinity()));
+            const auto liveMask = _mm_and_ps(_mm_castsi128_ps(_mm_and_si128(coverMask, rangeMask)), finiteMask);
+            const auto liveBits = static_cast<uint32_t>(_mm_movemask_ps(liveMask));
+            laneDepth = _mm_min_ps(_mm_max_ps(laneDepth, _mm_set1_ps(depthRange.x)), _mm_set1_ps(depthRange.y));
+            _mm_storeu_ps(depthOut + half, laneDepth);
+            if (liveBits == 0)
+                continue;
+
+            // SSE has no masked load/store, so only touch memory directly when all 4 lanes are live
+            auto* pDepthHalf = pDepth + half;
+            if (liveBits == 0xF)
+            {
+                const auto storedDepth = _mm_loadu_ps(pDepthHalf);
+                const auto compareMask = Test == DepthTest::Equal ? _mm_cmpeq_ps(laneDepth, storedDepth) : _mm_cmplt_ps(laneDepth, storedDepth);
+                const auto passMask = _mm_and_ps(liveMask, compareMask);
+                if constexpr (Test == DepthTest::Less)
+                    _mm_storeu_ps(pDepthHalf, _mm_or_ps(_mm_and_ps(passMask, laneDepth), _mm_andnot_ps(passMask, storedDepth)));
+                passBits |= static_cast<uint32_t>(_mm_movemask_ps(passMask)) << half;
+            }
+            else
+            {
+                for (uint32_t i = 0; i < 4; ++i)
+                {
+                    if ((liveBits & (1u << i)) == 0)
+                        continue;
+
+                    if constexpr (Test == DepthTest::Less)
+                    {
+                        if (depthOut[half + i] < pDepthHalf[i])
+                        {
+                            pDepthHalf[i] = depthOut[half + i];
+                            passBits |= 1u << (half + i);
+                        }
+                    }
+                    else if constexpr (Test == DepthTest::LessReadOnly)
+                    {
+                        if (depthOut[half + i] < pDepthHalf[i])
+                            passBits |= 1u << (half + i);
+                    }
+                    else if (depthOut[half + i] == pDepthHalf[i])
+                    {
+                        passBits |= 1u << (half + i);
+                    }
+                }
+            }
+        }
+        return passBits;
+#endif
+    }
+
+    /**
+     * Multisampled DepthTestSpan, every sample is tested against its own plane of the sample depth buffer.
+     * @param sampleOffsets added to the edge values at the pixel centers this gives the edge values at each sample
+     * @param sampleDepthOffsets added to the depth at the pixel centers this gives the depth at each sample
+     * @param pDepth first plane of the span in the sample depth buffer, the plane of sample s starts s * SpanWidth further
+     * @param depthOut interpolated depth of every lane per sample
+     * @return coverage mask, a byte per sample with a bit per lane (bit s * SpanWidth + lane)
+     * */
+    template <DepthTest Test, uint32_t SampleCount>
+    [[nodiscard]] inline uint32_t DepthTestSamples(const glm::ivec3& edges, const glm::ivec3 (&sampleOffsets)[SampleCount], const glm::ivec3& steps,
+                                                   const glm::vec2& depth, const float (&sampleDepthOffsets)[SampleCount], const glm::vec2& depthRange,
+                                                   const uint32_t laneCount, float* pDepth, float (&depthOut)[SampleCount][SpanWidth]) noexcept
+    {
+        static_assert(SampleCount * SpanWidth <= 32, "The coverage of a span has to fit in a single mask");
+
+        uint32_t coverageMask = 0;
+        for (uint32_t sample = 0; sample < SampleCount; ++sample)
+        {
+            const auto planeMask = DepthTestSpan<Test>(edges + sampleOffsets[sample], steps, depth + glm::vec2(sampleDepthOffsets[sample], 0.f), depthRange, laneCount, pDepth + sample * SpanWidth, depthOut[sample]);
+            coverageMask |= planeMask << (sample * SpanWidth);
+        }
+        return coverageMask;
+    }
+
+    //Pixels with at least one sample set in a coverage mask from DepthTestSamples
+    template <uint32_t SampleCount>
+    [[nodiscard]] constexpr uint32_t GetCoveredLanes(uint32_t coverageMask) noexcept
+    {
+        uint32_t laneMask = 0;
+        for (uint32_t sample = 0; sample < SampleCount; ++sample, coverageMask >>= SpanWidth)
+        {
+            laneMask |= coverageMask & ((1u << SpanWidth) - 1);
+        }
+        return laneMask;
+    }
+
+    //First sample of a lane that is set in a coverage mask from DepthTestSamples, the lane has to be covered
+    [[nodiscard]] constexpr uint32_t GetFirstSample(const uint32_t coverageMask, const uint32_t lane) noexcept
+    {
+        auto sample = 0u;
+        while ((coverageMask & (1u << (sample * SpanWidth + lane))) == 0)
+            ++sample;
+        return sample;
+    }
+
+    //8 floats processed together, used by the batched kernels that work on structure of arrays data
+    struct Float8
+    {
+#if defined(__AVX2__)
+        __m256 v;
+
+        [[nodiscard]] static Float8 Load(const float* pSrc) noexcept { return {_mm256_loadu_ps(pSrc)}; }
+        [[nodiscard]] static Float8 Broadcast(const float value) noexcept { return {_mm256_set1_ps(value)}; }
+        void Store(float* pDst) const noexcept { _mm256_storeu_ps(pDst, v); }
+
+        [[nodiscard]] friend Float8 operator+(const Float8& a, const Float8& b) noexcept { return {_mm256_add_ps(a.v, b.v)}; }
+        [[nodiscard]] friend Float8 operator-(const Float8& a, const Float8& b) noexcept { return {_mm256_sub_ps(a.v, b.v)}; }
+        [[nodiscard]] friend Float8 operator*(const Float8& a, const Float8& b) noexcept { return {_mm256_mul_ps(a.v, b.v)}; }
+        [[nodiscard]] friend Float8 operator/(const Float8& a, const Float8& b) noexcept { return {_mm256_div_ps(a.v, b.v)}; }
+        //a * b + c
+        [[nodiscard]] friend Float8 MulAdd(const Float8& a, const Float8& b, const Float8& c) noexcept { return {_mm256_fmadd_ps(a.v, b.v, c.v)}; }
+        [[nodiscard]] friend Float8 Sqrt(const Float8& a) noexcept { return {_mm256_sqrt_ps(a.v)}; }
+#else
+        __m128 lo;
+        __m128 hi;
+
+        [[nodiscard]] static Float8 Load(const float* pSrc) noexcept { return {_mm_loadu_ps(pSrc), _mm_loadu_ps(pSrc + 4)}; }
+        [[nodiscard]] static Float8 Broadcast(const float value) noexcept { return {_mm_set1_ps(value), _mm_set1_ps(value)}; }
+        void Store(float* pDst) const noexcept { _mm_storeu_ps(pDst, lo); _mm_storeu_ps(pDst + 4, hi); }
+
+        [[nodiscard]] friend Float8 operator+(const Float8& a, const Float8& b) noexcept { return {_mm_add_ps(a.lo, b.lo), _mm_add_ps(a.hi, b.hi)}; }
+        [[nodiscard]] friend Float8 operator-(const Float8& a, const Float8& b) noexcept { return {_mm_sub_ps(a.lo, b.lo), _mm_sub_ps(a.hi, b.hi)}; }
+        [[nodiscard]] friend Float8 operator*(const Float8& a, const Float8& b) noexcept { return {_mm_mul_ps(a.lo, b.lo), _mm_mul_ps(a.hi, b.hi)}; }
+        [[nodiscard]] friend Float8 operator/(const Float8& a, const Float8& b) noexcept { return {_mm_div_ps(a.lo, b.lo), _mm_div_ps(a.hi, b.hi)}; }
+        //a * b + c
+        [[nodiscard]] friend Float8 MulAdd(const Float8& a, const Float8& b, const Float8& c) noexcept { return a * b + c; }
+        [[nodiscard]] friend Float8 Sqrt(const Float8& a) noexcept { return {_mm_sqrt_ps(a.lo), _mm_sqrt_ps(a.hi)}; }
+#endif
+    };
+
+    //Where the 8 bit channels sit in a packed 32 bit pixel, resolved from the back buffer's format once per frame
+    struct PackedFormat
+    {
+        uint32_t redShift = 16;
+        uint32_t greenShift = 8;
+        uint32_t blueShift = 0;
+        uint32_t alphaMask = 0; // set in every pixel, opaque alpha for formats that have it
+    };
+
+    /**
+     * Converts 8 float colors to packed pixels, channels are saturated to [0, 1] and scaled to [0, 255] the way a cast would truncate them
+     * */
+    inline void PackColorSpan(const float (&red)[SpanWidth], const float (&green)[SpanWidth], const float (&blue)[SpanWidth],
+                              const PackedFormat& format, uint32_t (&packed)[SpanWidth]) noexcept
+    {
+#if defined(__AVX2__)
+        const auto scale = _mm256_set1_ps(255.f);
+        const auto zero = _mm256_setzero_ps();
+        // max comes first so NaN lanes end up as 0
+        const auto toChannel = [&](const float* pSrc, const uint32_t shift)
+        {
+            const auto channel = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(pSrc), scale), zero), scale);
+            return _mm256_sll_epi32(_mm256_cvttps_epi32(channel), _mm_cvtsi32_si128(static_cast<int32_t>(shift)));
+        };
+
+        auto pixels = _mm256_set1_epi32(static_cast<int32_t>(format.alphaMask));
+        pixels = _mm256_or_si256(pixels, toChannel(red, format.redShift));
+        pixels = _mm256_or_si256(pixels, toChannel(green, format.greenShift));
+        pixels = _mm256_or_si256(pixels, toChannel(blue, format.blueShift));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(packed), pixels);
+#else
+        const auto scale = _mm_set1_ps(255.f);
+        const auto zero = _mm_setzero_ps();
+        // max comes first so NaN lanes end up as 0
+        const auto toChannel = [&](const float* pSrc, const uint32_t shift)
+        {
+            const auto channel = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(pSrc), scale), zero), scale);
+            return _mm_sll_epi32(_mm_cvttps_epi32(channel), _mm_cvtsi32_si128(static_cast<int32_t>(shift)));
+        };
+
+        for (uint32_t half = 0; half < SpanWidth; half += 4)
+        {
+            auto pixels = _mm_set1_epi32(static_cast<int32_t>(format.alphaMask));
+            pixels = _mm_or_si128(pixels, toChannel(red + half, format.redShift));
+            pixels = _mm_or_si128(pixels, toChannel(green + half, format.greenShift));
+            pixels = _mm_or_si128(pixels, toChannel(blue + half, format.blueShift));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(packed + half), pixels);
+        }
+#endif
+    }
+
+    //Single pixel version of PackColorSpan, for clear colors and the odd pixel outside a span
+    [[nodiscard]] inline uint32_t PackColor(const glm::vec3& color, const PackedFormat& format) noexcept
+    {
+        const auto toChannel = [](const float value) { return static_cast<uint32_t>(std::min(std::max(0.f, value * 255.f), 255.f)); };
+        return format.alphaMask | toChannel(color.r) << format.redShift | toChannel(color.g) << format.greenShift | toChannel(color.b) << format.blueShift;
+    }
+
+    //Inverse of PackColor, channels in [0, 1]
+    [[nodiscard]] inline glm::vec3 UnpackColor(const uint32_t packed, const PackedFormat& format) noexcept
+    {
+        const auto toChannel = [packed](const uint32_t shift) { return static_cast<float>(packed >> shift & 0xFF) / 255.f; };
+        return {toChannel(format.redShift), toChannel(format.greenShift), toChannel(format.blueShift)};
+    }
+
+    /**
+     * Converts a whole buffer of float colors to packed pixels, for full screen outputs like the RT render or a post-process pass
+     * */
+    inline void PackColors(const glm::vec3* pColors, const uint32_t count, const PackedFormat& format, uint32_t* pDst) noexcept
+    {
+        float red[SpanWidth]{}, green[SpanWidth]{}, blue[SpanWidth]{};
+        uint32_t packed[SpanWidth];
+        for (uint32_t first = 0; first < count; first += SpanWidth)
+        {
+            const auto laneCount = std::min(SpanWidth, count - first);
+            for (uint32_t lane = 0; lane < laneCount; ++lane)
+            {
+                red[lane] = pColors[first + lane].r;
+                green[lane] = pColors[first + lane].g;
+                blue[lane] = pColors[first + lane].b;
+            }
+            PackColorSpan(red, green, blue, format, packed);
+            std::copy_n(packed, laneCount, pDst + first);
+        }
+    }
+
+    /**
+     * Averages the 4 sample planes of a span of packed pixels, rounded to nearest.
+     * Every byte is averaged on its own, so this works for any 8 bit per channel format.
+     * @param pSamples first plane of the span, the plane of sample s starts s * SpanWidth further
+     * */
+    inline void ResolveSpan4x(const uint32_t* pSamples, uint32_t (&resolved)[SpanWidth]) noexcept
+    {
+#if defined(__AVX2__)
+        // Bytes are widened to 16 bits within each 128 bit lane, packing them back undoes the shuffle
+        const auto zero = _mm256_setzero_si256();
+        auto low = _mm256_set1_epi16(2);
+        auto high = low;
+        for (uint32_t sample = 0; sample < 4; ++sample)
+        {
+            const auto plane = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSamples + sample * SpanWidth));
+            low = _mm256_add_epi16(low, _mm256_unpacklo_epi8(plane, zero));
+            high = _mm256_add_epi16(high, _mm256_unpackhi_epi8(plane, zero));
+        }
+        const auto average = _mm256_packus_epi16(_mm256_srli_epi16(low, 2), _mm256_srli_epi16(high, 2));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(resolved), average);
+#else
+        const auto zero = _mm_setzero_si128();
+        for (uint32_t half = 0; half < SpanWidth; half += 4)
+        {
+            auto low = _mm_set1_epi16(2);
+            auto high = low;
+            for (uint32_t sample = 0; sample < 4; ++sample)
+            {
+                const auto plane = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSamples + sample * SpanWidth + half));
+                low = _mm_add_epi16(low, _mm_unpacklo_epi8(plane, zero));
+                high = _mm_add_epi16(high, _mm_unpackhi_epi8(plane, zero));
+            }
+            const auto average = _mm_packus_epi16(_mm_srli_epi16(low, 2), _mm_srli_epi16(high, 2));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(resolved + half), average);
+        }
+#endif
+    }
+
+    /**
+     * Stores the lanes of values selected by mask to pDst, other lanes are left untouched
+     * */
+    inline void StoreMasked(uint32_t* pDst, const uint32_t (&values)[SpanWidth], const uint32_t mask) noexcept
+    {
+#if defined(__AVX2__)
+        const auto laneBits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+        const auto laneMask = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(static_cast<int32_t>(mask)), laneBits), laneBits);
+        _mm256_maskstore_epi32(reinterpret_cast<int32_t*>(pDst), laneMask, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values)));
+#else
+        for (uint32_t i = 0; i < SpanWidth; ++i)
+        {
+            if (mask & (1u << i))
+                pDst[i] = values[i];
+        }
+#endif
+    }
+}
+
+#endif // !SIMD_HELPERS_HPP
@@ -1,8 +1,16 @@
 #ifndef VERTEX_HPP
 #define VERTEX_HPP
 
+//Standard includes
+#include <cstring>
+#include <vector>
+
 //Project includes
 #include "Helpers/GeneralHelpers.hpp"
+#include "Helpers/FrameArena.hpp"
+
+//Structure of arrays streams are padded to a multiple of this, so the vertex kernel always works on full batches
+constexpr uint32_t VertexBatchSize = 8;
 
 struct VertexInput
 {
@@ -33,37 +41,120 @@ struct VertexOutput
     glm::vec3 normal = {};
     glm::vec3 tangent = {};
     glm::vec3 viewDirection = {};
-    bool culled = {false};
+    glm::vec2 uvDx = {}; // screen space derivatives of uv, only filled in for fragments
+    glm::vec2 uvDy = {};
+    uint32_t clipCodes = {0}; // bgh::ClipCode bits, pos stays in clip space while any bgh::ClipRequired bit is set
 
     //Constructors
     VertexOutput() = default;
 };
 
-template<typename Attribute>
-Attribute InterpolateInternal(const Attribute& a0, const Attribute& a1, const Attribute& a2, const glm::vec3 packedInvDepth, const TriangleResult& triResult, float interpolatedDepth)
+//Structure of arrays copy of a mesh's vertices, one stream per component
+struct VertexInputStreams
 {
-    auto [invDepth0, invDepth1, invDepth2] = packedInvDepth;
-    const auto [w0, w1, w2] = triResult;
-    
-    Attribute attribute0 = a0 * invDepth0 * w0;
-    Attribute attribute1 = a1 * invDepth1 * w1;
-    Attribute attribute2 = a2 * invDepth2 * w2;
-    return (attribute0 + attribute1 + attribute2) * interpolatedDepth;
-}
-
-inline VertexOutput Interpolate(const VertexOutput& v0, const VertexOutput& v1, const VertexOutput& v2, const TriangleResult& triResult, float interpolatedDepth)
+    std::vector<float> posX, posY, posZ;
+    std::vector<float> u, v;
+    std::vector<float> normalX, normalY, normalZ;
+    std::vector<float> tangentX, tangentY, tangentZ;
+    uint32_t count = 0;
+
+    void Assign(const std::vector<VertexInput>& vertices)
+    {
+        count = static_cast<uint32_t>(vertices.size());
+        const auto paddedCount = (count + VertexBatchSize - 1) / VertexBatchSize * VertexBatchSize;
+        for (auto* pStream : {&posX, &posY, &posZ, &u, &v, &normalX, &normalY, &normalZ, &tangentX, &tangentY, &tangentZ})
+        {
+            pStream->assign(paddedCount, 0.f);
+        }
+
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const auto& vertex = vertices[i];
+            posX[i] = vertex.pos.x; posY[i] = vertex.pos.y; posZ[i] = vertex.pos.z;
+            u[i] = vertex.uv.x; v[i] = vertex.uv.y;
+            normalX[i] = vertex.normal.x; normalY[i] = vertex.normal.y; normalZ[i] = vertex.normal.z;
+            tangentX[i] = vertex.tangent.x; tangentY[i] = vertex.tangent.y; tangentZ[i] = vertex.tangent.z;
+        }
+    }
+};
+
+//Structure of arrays post transform vertices, written 8 at a time by the vertex kernel.
+//The streams live in the frame arena, vertices produced by clipping are appended behind the transformed ones.
+struct VertexOutputStreams
 {
-    VertexOutput vReturn{};
-    
-    // Packing the depth for convenience
-    glm::vec3 packedInvDepth {1.f / v0.pos.w, 1.f / v1.pos.w, 1.f / v2.pos.w};
-
-    vReturn.worldPos = InterpolateInternal(v0.worldPos, v1.worldPos, v2.worldPos, packedInvDepth, triResult, interpolatedDepth);
-    vReturn.uv = InterpolateInternal(v0.uv, v1.uv, v2.uv, packedInvDepth, triResult, interpolatedDepth);
-    vReturn.normal = InterpolateInternal(v0.normal, v1.normal, v2.normal, packedInvDepth, triResult, interpolatedDepth);
-    vReturn.tangent = InterpolateInternal(v0.tangent, v1.tangent, v2.tangent, packedInvDepth, triResult, interpolatedDepth);
-    vReturn.viewDirection = InterpolateInternal(v0.viewDirection, v1.viewDirection, v2.viewDirection, packedInvDepth, triResult, interpolatedDepth);
-
-    return vReturn;
-}
+    float* posX = nullptr; float* posY = nullptr; float* posZ = nullptr; float* posW = nullptr;
+    float* worldX = nullptr; float* worldY = nullptr; float* worldZ = nullptr;
+    float* u = nullptr; float* v = nullptr;
+    float* normalX = nullptr; float* normalY = nullptr; float* normalZ = nullptr;
+    float* tangentX = nullptr; float* tangentY = nullptr; float* tangentZ = nullptr;
+    float* viewX = nullptr; float* viewY = nullptr; float* viewZ = nullptr;
+    uint32_t* clipCodes = nullptr;
+    uint32_t count = 0;
+    uint32_t capacity = 0;
+    FrameArena* pArena = nullptr;
+
+    //Fresh streams for this frame, the previous ones went away with the arena reset
+    void Allocate(FrameArena& arena, const uint32_t vertexCount)
+    {
+        pArena = &arena;
+        count = 0;
+        capacity = 0;
+        // Leave room for a few clipped vertices before the streams have to move
+        Grow((vertexCount + VertexBatchSize - 1) / VertexBatchSize * VertexBatchSize + 4 * VertexBatchSize);
+        count = vertexCount;
+    }
+
+    void PushBack(const VertexOutput& vertex)
+    {
+        if (count == capacity)
+            Grow(capacity * 2);
+        Set(count++, vertex);
+    }
+
+    void Set(const uint32_t idx, const VertexOutput& vertex) noexcept
+    {
+        posX[idx] = vertex.pos.x; posY[idx] = vertex.pos.y; posZ[idx] = vertex.pos.z; posW[idx] = vertex.pos.w;
+        worldX[idx] = vertex.worldPos.x; worldY[idx] = vertex.worldPos.y; worldZ[idx] = vertex.worldPos.z;
+        u[idx] = vertex.uv.x; v[idx] = vertex.uv.y;
+        normalX[idx] = vertex.normal.x; normalY[idx] = vertex.normal.y; normalZ[idx] = vertex.normal.z;
+        tangentX[idx] = vertex.tangent.x; tangentY[idx] = vertex.tangent.y; tangentZ[idx] = vertex.tangent.z;
+        viewX[idx] = vertex.viewDirection.x; viewY[idx] = vertex.viewDirection.y; viewZ[idx] = vertex.viewDirection.z;
+        clipCodes[idx] = vertex.clipCodes;
+    }
+
+    [[nodiscard]] auto Get(const uint32_t idx) const noexcept -> VertexOutput
+    {
+        VertexOutput vertex{};
+        vertex.pos = {posX[idx], posY[idx], posZ[idx], posW[idx]};
+        vertex.worldPos = {worldX[idx], worldY[idx], worldZ[idx]};
+        vertex.uv = {u[idx], v[idx]};
+        vertex.normal = {normalX[idx], normalY[idx], normalZ[idx]};
+        vertex.tangent = {tangentX[idx], tangentY[idx], tangentZ[idx]};
+        vertex.viewDirection = {viewX[idx], viewY[idx], viewZ[idx]};
+        vertex.clipCodes = clipCodes[idx];
+        return vertex;
+    }
+
+    [[nodiscard]] auto GetScreenPos(const uint32_t idx) const noexcept -> glm::vec2 { return {posX[idx], posY[idx]}; }
+
+private:
+    void Grow(const uint32_t newCapacity)
+    {
+        for (auto** ppStream : {&posX, &posY, &posZ, &posW, &worldX, &worldY, &worldZ, &u, &v,
+                                &normalX, &normalY, &normalZ, &tangentX, &tangentY, &tangentZ, &viewX, &viewY, &viewZ})
+        {
+            auto* pStream = pArena->Allocate<float>(newCapacity);
+            if (count > 0)
+                std::memcpy(pStream, *ppStream, sizeof(float) * count);
+            *ppStream = pStream;
+        }
+
+        auto* pClipCodes = pArena->Allocate<uint32_t>(newCapacity);
+        if (count > 0)
+            std::memcpy(pClipCodes, clipCodes, sizeof(uint32_t) * count);
+        clipCodes = pClipCodes;
+        capacity = newCapacity;
+    }
+};
+
 #endif // !VERTEX_HPP
@@ -0,0 +1,160 @@
+#include "pch.h"
+#include "Materials/BlockCompression.hpp"
+
+#include <cfloat>
+#include <utility>
+
+namespace
+{
+    uint32_t QuantizeTo565(const glm::vec3& color) noexcept
+    {
+        const auto clamped = glm::clamp(color, 0.f, 1.f);
+        return static_cast<uint32_t>(clamped.r * 31.f + 0.5f) << 11 | static_cast<uint32_t>(clamped.g * 63.f + 0.5f) << 5 | static_cast<uint32_t>(clamped.b * 31.f + 0.5f);
+    }
+
+    //Picks the nearest entry of the 4 color palette for every texel, returns the total squared error
+    float SelectIndices(const glm::vec3 (&colors)[BlockCompression::TexelsPerBlock], const uint32_t color0, const uint32_t color1, uint32_t& indices) noexcept
+    {
+        const auto endpoint0 = BlockCompression::Expand565(color0);
+        const auto endpoint1 = BlockCompression::Expand565(color1);
+        const glm::vec3 palette[4] = {endpoint0, endpoint1, glm::mix(endpoint0, endpoint1, 1.f / 3.f), glm::mix(endpoint0, endpoint1, 2.f / 3.f)};
+
+        auto totalError = 0.f;
+        indices = 0;
+        for (uint32_t texelIdx = 0; texelIdx < BlockCompression::TexelsPerBlock; ++texelIdx)
+        {
+            uint32_t bestIndex = 0;
+            auto bestError = FLT_MAX;
+            for (uint32_t index = 0; index < 4; ++index)
+            {
+                const auto difference = colors[texelIdx] - palette[index];
+                const auto error = glm::dot(difference, difference);
+                if (error < bestError)
+                {
+                    bestError = error;
+                    bestIndex = index;
+                }
+            }
+            indices |= bestIndex << (2 * texelIdx);
+            totalError += bestError;
+        }
+        return totalError;
+    }
+
+    uint64_t MakeBC1Block(uint32_t color0, uint32_t color1, uint32_t indices) noexcept
+    {
+        // The 4 color palette needs color0 > color1, swapping the endpoints swaps index 0 with 1 and 2 with 3
+        if (color0 < color1)
+        {
+            std::swap(color0, color1);
+            indices ^= 0x55555555;
+        }
+        else if (color0 == color1)
+        {
+            indices = 0;
+        }
+        return static_cast<uint64_t>(color0) | static_cast<uint64_t>(color1) << 16 | static_cast<uint64_t>(indices) << 32;
+    }
+}
+
+uint64_t BlockCompression::EncodeBC1(const uint32_t (&texels)[TexelsPerBlock])
+{
+    glm::vec3 colors[TexelsPerBlock];
+    glm::vec3 mean{0.f};
+    for (uint32_t texelIdx = 0; texelIdx < TexelsPerBlock; ++texelIdx)
+    {
+        const auto texel = texels[texelIdx];
+        colors[texelIdx] = glm::vec3(static_cast<float>(texel & 0xFF), static_cast<float>(texel >> 8 & 0xFF), static_cast<float>(texel >> 16 & 0xFF)) / 255.f;
+        mean += colors[texelIdx];
+    }
+    mean /= static_cast<float>(TexelsPerBlock);
+
+    // Endpoints are the extremes along the principal axis of the block's colors, found by power iteration on the covariance
+    glm::mat3 covariance{0.f};
+    for (const auto& color : colors)
+    {
+        const auto offset = color - mean;
+        covariance += glm::outerProduct(offset, offset);
+    }
+    glm::vec3 axis{1.f, 1.f, 1.f};
+    for (uint32_t iteration = 0; iteration < 8; ++iteration)
+    {
+        axis = covariance * axis;
+        const auto length = glm::length(axis);
+        if (length < 1e-12f)
+            break;
+        axis /= length;
+    }
+
+    auto minProjection = FLT_MAX;
+    auto maxProjection = -FLT_MAX;
+    for (const auto& color : colors)
+    {
+        const auto projection = glm::dot(color - mean, axis);
+        minProjection = std::min(minProjection, projection);
+        maxProjection = std::max(maxProjection, projection);
+    }
+
+    auto color0 = QuantizeTo565(mean + axis * maxProjection);
+    auto color1 = QuantizeTo565(mean + axis * minProjection);
+    uint32_t indices;
+    auto error = SelectIndices(colors, color0, color1, indices);
+
+    // One least squares pass fits the endpoints to the chosen indices, kept only when it lowers the error
+    constexpr float weights[4] = {0.f, 1.f, 1.f / 3.f, 2.f / 3.f};
+    float alpha2 = 0.f, beta2 = 0.f, alphaBeta = 0.f;
+    glm::vec3 alphaColor{0.f}, betaColor{0.f};
+    for (uint32_t texelIdx = 0; texelIdx < TexelsPerBlock; ++texelIdx)
+    {
+        const auto beta = weights[indices >> (2 * texelIdx) & 0x3];
+        const auto alpha = 1.f - beta;
+        alpha2 += alpha * alpha;
+        beta2 += beta * beta;
+        alphaBeta += alpha * beta;
+        alphaColor += colors[texelIdx] * alpha;
+        betaColor += colors[texelIdx] * beta;
+    }
+    const auto determinant = alpha2 * beta2 - alphaBeta * alphaBeta;
+    if (std::abs(determinant) > 1e-6f)
+    {
+        const auto refined0 = QuantizeTo565((alphaColor * beta2 - betaColor * alphaBeta) / determinant);
+        const auto refined1 = QuantizeTo565((betaColor * alpha2 - alphaColor * alphaBeta) / determinant);
+        uint32_t refinedIndices;
+        if (SelectIndices(colors, refined0, refined1, refinedIndices) < error)
+        {
+            color0 = refined0;
+            color1 = refined1;
+            indices = refinedIndices;
+        }
+    }
+
+    return MakeBC1Block(color0, color1, indices);
+}
+
+uint64_t BlockCompression::EncodeBC4(const uint32_t (&texels)[TexelsPerBlock], const uint32_t channelShift)
+{
+    uint32_t values[TexelsPerBlock];
+    uint32_t minValue = 255;
+    uint32_t maxValue = 0;
+    for (uint32_t texelIdx = 0; texelIdx < TexelsPerBlock; ++texelIdx)
+    {
+        values[texelIdx] = texels[texelIdx] >> channelShift & 0xFF;
+        minValue = std::min(minValue, values[texelIdx]);
+        maxValue = std::max(maxValue, values[texelIdx]);
+    }
+
+    // A flat block is just endpoint 0, everything else uses the 8 value palette running from max to min
+    uint64_t block = static_cast<uint64_t>(maxValue) | static_cast<uint64_t>(minValue) << 8;
+    if (maxValue == minValue)
+        return block;
+
+    const auto range = static_cast<float>(maxValue - minValue);
+    for (uint32_t texelIdx = 0; texelIdx < TexelsPerBlock; ++texelIdx)
+    {
+        // Steps from endpoint 0 towards endpoint 1, step 0 is index 0, step 7 index 1 and the steps in between indices 2 to 7
+        const auto step = static_cast<uint32_t>(static_cast<float>(maxValue - values[texelIdx]) / range * 7.f + 0.5f);
+        const auto index = step == 0 ? 0u : step == 7 ? 1u : step + 1;
+        block |= static_cast<uint64_t>(index) << (16 + 3 * texelIdx);
+    }
+    return block;
+}
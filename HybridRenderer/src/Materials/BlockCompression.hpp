@@ -0,0 +1,73 @@
+#ifndef BLOCK_COMPRESSION_HPP
+#define BLOCK_COMPRESSION_HPP
+
+//Standard includes
+#include <cstdint>
+
+//Project includes
+#include "Helpers/MathHelpers.hpp"
+
+//BC1, BC4 and BC5 style 4x4 texel blocks for the software textures, bit layouts match D3D's so the data could be uploaded as is.
+//Texels inside a block are numbered row major, decoding a single texel only reads its own block.
+namespace BlockCompression
+{
+    constexpr uint32_t BlockSize = 4;
+    constexpr uint32_t TexelsPerBlock = BlockSize * BlockSize;
+
+    //Encoders, texels are RGBA8 with red in the low byte
+    [[nodiscard]] uint64_t EncodeBC1(const uint32_t (&texels)[TexelsPerBlock]);
+    //Single channel, channelShift picks the byte of each texel
+    [[nodiscard]] uint64_t EncodeBC4(const uint32_t (&texels)[TexelsPerBlock], uint32_t channelShift = 0);
+
+    [[nodiscard]] inline glm::vec3 Expand565(const uint32_t color) noexcept
+    {
+        return {static_cast<float>(color >> 11 & 0x1F) / 31.f, static_cast<float>(color >> 5 & 0x3F) / 63.f, static_cast<float>(color & 0x1F) / 31.f};
+    }
+
+    //BC1: two RGB565 endpoints and a 2 bit palette index per texel, 8 bytes
+    [[nodiscard]] inline glm::vec4 DecodeBC1(const uint64_t block, const uint32_t texelIdx) noexcept
+    {
+        const auto color0 = static_cast<uint32_t>(block & 0xFFFF);
+        const auto color1 = static_cast<uint32_t>(block >> 16 & 0xFFFF);
+        const auto index = static_cast<uint32_t>(block >> (32 + 2 * texelIdx) & 0x3);
+
+        // color0 > color1 selects the 4 color palette, otherwise index 3 is transparent black
+        constexpr float fourColorWeights[4] = {0.f, 1.f, 1.f / 3.f, 2.f / 3.f};
+        constexpr float threeColorWeights[4] = {0.f, 1.f, 0.5f, 0.f};
+        if (color0 <= color1 && index == 3)
+            return glm::vec4{0.f};
+
+        const auto weight = color0 > color1 ? fourColorWeights[index] : threeColorWeights[index];
+        const auto endpoint0 = Expand565(color0);
+        return {endpoint0 + (Expand565(color1) - endpoint0) * weight, 1.f};
+    }
+
+    //BC4: two 8 bit endpoints and a 3 bit palette index per texel, 8 bytes
+    [[nodiscard]] inline float DecodeBC4(const uint64_t block, const uint32_t texelIdx) noexcept
+    {
+        const auto value0 = static_cast<float>(block & 0xFF);
+        const auto value1 = static_cast<float>(block >> 8 & 0xFF);
+        const auto index = static_cast<uint32_t>(block >> (16 + 3 * texelIdx) & 0x7);
+
+        if (index == 0)
+            return value0 / 255.f;
+        if (index == 1)
+            return value1 / 255.f;
+
+        // value0 > value1 interpolates 6 values in between, otherwise 4 and the last two indices are 0 and 1
+        const auto step = static_cast<float>(index - 1);
+        if (value0 > value1)
+            return (value0 * (7.f - step) + value1 * step) / (7.f * 255.f);
+        if (index >= 6)
+            return index == 6 ? 0.f : 1.f;
+        return (value0 * (5.f - step) + value1 * step) / (5.f * 255.f);
+    }
+
+    //BC5: a BC4 block for x followed by one for y, 16 bytes
+    [[nodiscard]] inline glm::vec2 DecodeBC5(const uint64_t* pBlock, const uint32_t texelIdx) noexcept
+    {
+        return {DecodeBC4(pBlock[0], texelIdx), DecodeBC4(pBlock[1], texelIdx)};
+    }
+}
+
+#endif // !BLOCK_COMPRESSION_HPP
@@ -0,0 +1,119 @@
+#ifndef BLOCK_MIP_CHAIN_HPP
+#define BLOCK_MIP_CHAIN_HPP
+
+//Standard includes
+#include <cstdint>
+#include <vector>
+
+//Project includes
+#include "Materials/BlockCompression.hpp"
+#include "Materials/MipChain.hpp"
+
+//Mip levels of a block compressed texture, every level is stored as rows of 4x4 texel blocks.
+//A block is 1 (BC1, BC4) or 2 (BC5) 64 bit words, a row of blocks already covers 4 texel rows so no further tiling is needed.
+class BlockMipChain final
+{
+public:
+    struct MipLevel
+    {
+        uint32_t width;
+        uint32_t height;
+        uint32_t blocksX;
+        uint32_t firstWord; // offset of the level in the block words
+    };
+
+    explicit BlockMipChain(const uint32_t blockWords = 1)
+        : m_BlockWords(blockWords)
+    {
+    }
+
+    //Lays out every level down to 1x1, blocks are zeroed
+    void Allocate(const uint32_t width, const uint32_t height)
+    {
+        constexpr auto blockSize = BlockCompression::BlockSize;
+        m_Levels.clear();
+        uint32_t wordCount = 0;
+        auto levelWidth = std::max(1u, width);
+        auto levelHeight = std::max(1u, height);
+        while (true)
+        {
+            // Edge blocks are padded with clamped texels, the samplers clamp before addressing so the padding is never read
+            const MipLevel level{levelWidth, levelHeight, (levelWidth + blockSize - 1) / blockSize, wordCount};
+            wordCount += level.blocksX * ((levelHeight + blockSize - 1) / blockSize) * m_BlockWords;
+            m_Levels.push_back(level);
+
+            if (levelWidth == 1 && levelHeight == 1)
+                break;
+            levelWidth = std::max(1u, levelWidth / 2);
+            levelHeight = std::max(1u, levelHeight / 2);
+        }
+        m_Words.assign(wordCount, 0);
+    }
+
+    /**
+     * Compresses every level of an RGBA8 chain
+     * @param encode writes the block for 16 RGBA8 texels, encode(const uint32_t (&texels)[16], uint64_t* pBlock)
+     * */
+    template <typename Encode>
+    void Compress(const MipChain<uint32_t>& source, const Encode& encode)
+    {
+        constexpr auto blockSize = BlockCompression::BlockSize;
+        Allocate(source.GetLevel(0).width, source.GetLevel(0).height);
+        for (uint32_t mip = 0; mip < GetMipCount(); ++mip)
+        {
+            const auto& level = m_Levels[mip];
+            const auto blocksY = (level.height + blockSize - 1) / blockSize;
+            for (uint32_t blockY = 0; blockY < blocksY; ++blockY)
+            {
+                for (uint32_t blockX = 0; blockX < level.blocksX; ++blockX)
+                {
+                    uint32_t texels[BlockCompression::TexelsPerBlock];
+                    for (uint32_t texelIdx = 0; texelIdx < BlockCompression::TexelsPerBlock; ++texelIdx)
+                    {
+                        const auto x = std::min(blockX * blockSize + texelIdx % blockSize, level.width - 1);
+                        const auto y = std::min(blockY * blockSize + texelIdx / blockSize, level.height - 1);
+                        texels[texelIdx] = source.GetTexel(mip, x, y);
+                    }
+                    encode(texels, &m_Words[level.firstWord + (blockX + blockY * level.blocksX) * m_BlockWords]);
+                }
+            }
+        }
+    }
+
+    /**
+     * Filters the chain at a footprint
+     * @param decode decodes one texel of a block, decode(const uint64_t* pBlock, uint32_t texelIdx) -> Decoded
+     * */
+    template <typename Decoded, typename Decode>
+    [[nodiscard]] Decoded Filter(const SampleFootprint& footprint, const Decode& decode) const noexcept
+    {
+        return MipFilter::Filter<Decoded>(m_Levels, footprint, [this, &decode](const uint32_t mip, const uint32_t x, const uint32_t y)
+        {
+            return decode(GetBlock(mip, x, y), GetTexelInBlock(x, y));
+        });
+    }
+
+    //Getters
+    [[nodiscard]] auto GetBlock(const uint32_t mip, const uint32_t x, const uint32_t y) const noexcept -> const uint64_t*
+    {
+        const auto& level = m_Levels[mip];
+        return &m_Words[level.firstWord + (x / BlockCompression::BlockSize + y / BlockCompression::BlockSize * level.blocksX) * m_BlockWords];
+    }
+    [[nodiscard]] static constexpr auto GetTexelInBlock(const uint32_t x, const uint32_t y) noexcept -> uint32_t
+    {
+        return y % BlockCompression::BlockSize * BlockCompression::BlockSize + x % BlockCompression::BlockSize;
+    }
+    [[nodiscard]] auto GetLevel(const uint32_t mip) const noexcept -> const MipLevel& { return m_Levels[mip]; }
+    [[nodiscard]] auto GetMipCount() const noexcept -> uint32_t { return static_cast<uint32_t>(m_Levels.size()); }
+    [[nodiscard]] constexpr auto GetBlockWords() const noexcept -> uint32_t { return m_BlockWords; }
+    //Raw blocks of every level, what the texture cache reads and writes
+    [[nodiscard]] auto GetStorage() noexcept -> std::vector<uint64_t>& { return m_Words; }
+    [[nodiscard]] auto GetStorage() const noexcept -> const std::vector<uint64_t>& { return m_Words; }
+
+private:
+    std::vector<MipLevel> m_Levels;
+    std::vector<uint64_t> m_Words;
+    uint32_t m_BlockWords;
+};
+
+#endif // !BLOCK_MIP_CHAIN_HPP
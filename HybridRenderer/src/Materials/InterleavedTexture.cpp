@@ -0,0 +1,63 @@
+#include "pch.h"
+#include "Materials/InterleavedTexture.hpp"
+
+#include "Debugging/Logger.hpp"
+#include "Materials/Texture.hpp"
+#include "Materials/TextureCache.hpp"
+
+InterleavedTexture::InterleavedTexture()
+    : m_IsValid(false)
+{
+}
+
+#pragma region Workers
+void InterleavedTexture::Interleave(const Texture& diffuseMap, const Texture& normalMap, const Texture& glossMap, const Texture& specularMap)
+{
+    const std::vector<std::string> sourcePaths{diffuseMap.GetFilePath(), normalMap.GetFilePath(), glossMap.GetFilePath(), specularMap.GetFilePath()};
+
+    // Equal mip 0 sizes give equal chains, so every level lines up
+    const auto width = diffuseMap.GetWidth();
+    const auto height = diffuseMap.GetHeight();
+    for (const auto* pMap : {&normalMap, &glossMap, &specularMap})
+    {
+        if (pMap->GetWidth() != width || pMap->GetHeight() != height)
+        {
+            LOG(LEVEL_WARNING, "Maps of " << sourcePaths.front() << " differ in size, they are sampled separately")
+            return;
+        }
+    }
+    m_IsValid = true;
+
+    const auto cachePath = TextureCache::GetPath(sourcePaths.front(), "interleaved");
+    if (TextureCache::LoadChain(cachePath, TextureCache::Format::Interleaved, sourcePaths, m_Mips) && m_Mips.GetLevel(0).width == width && m_Mips.GetLevel(0).height == height)
+        return;
+
+    m_Mips.Allocate(width, height);
+    for (uint32_t mip = 0; mip < m_Mips.GetMipCount(); ++mip)
+    {
+        const auto& level = m_Mips.GetLevel(mip);
+        for (uint32_t y = 0; y < level.height; ++y)
+        {
+            for (uint32_t x = 0; x < level.width; ++x)
+            {
+                m_Mips.SetTexel(mip, x, y, Pack(diffuseMap.GetTexel(mip, x, y), normalMap.GetTexel(mip, x, y), glossMap.GetTexel(mip, x, y), specularMap.GetTexel(mip, x, y)));
+            }
+        }
+    }
+
+    TextureCache::StoreChain(cachePath, TextureCache::Format::Interleaved, m_Mips);
+}
+#pragma endregion
+
+uint64_t InterleavedTexture::Pack(const uint32_t diffuse, const uint32_t normal, const uint32_t gloss, const uint32_t specular) noexcept
+{
+    // Specular only tints the highlights, 5 or 6 bits per channel are plenty for it
+    const auto quantize = [specular](const uint32_t shift, const uint32_t maxValue) { return static_cast<uint64_t>(((specular >> shift & 0xFF) * maxValue + 127) / 255); };
+    const auto specular565 = quantize(0, 31) | quantize(8, 63) << 5 | quantize(16, 31) << 11;
+
+    // Normal x and y are stored as signed c - 128 by flipping their top bits, z is rebuilt when sampling
+    return static_cast<uint64_t>(diffuse & 0x00FFFFFF)
+        | static_cast<uint64_t>(gloss & 0xFF) << 24
+        | specular565 << 32
+        | static_cast<uint64_t>((normal ^ 0x8080) & 0xFFFF) << 48;
+}
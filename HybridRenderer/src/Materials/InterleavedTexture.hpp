@@ -0,0 +1,78 @@
+#ifndef INTERLEAVED_TEXTURE_HPP
+#define INTERLEAVED_TEXTURE_HPP
+
+//Standard includes
+#include <string>
+#include <vector>
+
+//Project includes
+#include "Helpers/RGBColor.hpp"
+#include "Materials/MipChain.hpp"
+
+class Texture;
+
+//Every map of a mapped material at one texel, blended as a whole while filtering
+struct MaterialTexel
+{
+    RGBColor diffuse;
+    RGBColor specular;
+    glm::vec2 normal; // tangent space x and y in [-1, 1]
+    float gloss;
+
+    //Tangent space normal, z is rebuilt after filtering so the result is unit length
+    [[nodiscard]] glm::vec3 GetNormal() const noexcept
+    {
+        return {normal, std::sqrt(std::max(0.f, 1.f - glm::dot(normal, normal)))};
+    }
+
+    [[nodiscard]] friend MaterialTexel operator+(const MaterialTexel& a, const MaterialTexel& b) noexcept { return {a.diffuse + b.diffuse, a.specular + b.specular, a.normal + b.normal, a.gloss + b.gloss}; }
+    [[nodiscard]] friend MaterialTexel operator-(const MaterialTexel& a, const MaterialTexel& b) noexcept { return {a.diffuse - b.diffuse, a.specular - b.specular, a.normal - b.normal, a.gloss - b.gloss}; }
+    [[nodiscard]] friend MaterialTexel operator*(const MaterialTexel& a, const float s) noexcept { return {a.diffuse * s, a.specular * s, a.normal * s, a.gloss * s}; }
+};
+
+//The diffuse, normal, gloss and specular maps packed into one 8 byte texel, a single fetch (and cache line) serves all four lookups.
+//Layout, low to high: diffuse RGB8, gloss 8, specular RGB565, normal xy as signed bytes.
+//Packed at load from the maps' own mip chains and cached next to the diffuse map.
+//Empty until Interleave ran, TextureLoader::QueueInterleaved hands them out before the maps are decoded.
+class InterleavedTexture final
+{
+public:
+    InterleavedTexture();
+    ~InterleavedTexture() = default;
+    DEL_ROF(InterleavedTexture)
+
+    //Workers
+    //The maps have to hold their texels already and need the same size, IsValid tells whether they could be packed
+    void Interleave(const Texture& diffuseMap, const Texture& normalMap, const Texture& glossMap, const Texture& specularMap);
+
+    [[nodiscard]] MaterialTexel Sample(const SampleFootprint& footprint) const noexcept
+    {
+        return m_Mips.Filter<MaterialTexel>(footprint, Unpack);
+    }
+
+    //Getters
+    [[nodiscard]] constexpr auto IsValid() const noexcept -> bool { return m_IsValid; }
+
+private:
+    MipChain<uint64_t> m_Mips;
+    bool m_IsValid;
+
+    [[nodiscard]] static uint64_t Pack(uint32_t diffuse, uint32_t normal, uint32_t gloss, uint32_t specular) noexcept;
+
+    [[nodiscard]] static MaterialTexel Unpack(const uint64_t texel) noexcept
+    {
+        const auto byte = [texel](const uint32_t shift) { return static_cast<float>(texel >> shift & 0xFF); };
+        const auto field = [texel](const uint32_t shift, const uint32_t mask) { return static_cast<float>(texel >> shift & mask); };
+        //Normal bytes are stored as c - 128, (2s + 1) / 255 gives back exactly c / 255 * 2 - 1
+        const auto signedByte = [texel](const uint32_t shift) { return static_cast<float>(2 * static_cast<int32_t>(static_cast<int8_t>(texel >> shift & 0xFF)) + 1) / 255.f; };
+
+        return {
+            RGBColor(byte(0), byte(8), byte(16)) / 255.f,
+            RGBColor(field(32, 0x1F) / 31.f, field(37, 0x3F) / 63.f, field(43, 0x1F) / 31.f),
+            glm::vec2(signedByte(48), signedByte(56)),
+            byte(24) / 255.f
+        };
+    }
+};
+
+#endif // !INTERLEAVED_TEXTURE_HPP
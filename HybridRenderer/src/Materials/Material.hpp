@@ -11,9 +11,18 @@
 //Project includes
 #include "Debugging/Logger.hpp"
 #include "Helpers/Vertex.hpp"
+#include "Materials/Texture.hpp"
 #include "Scene/SceneGraph.hpp"
 //#include "Scene/SceneGraph.hpp"
 
+#ifdef HYBRID_HEADLESS
+// Without a device there is no effect to query, every D3D handle stays null
+#define D3DLOAD_TECH(effect, tech, name) \
+    tech = nullptr;
+
+#define D3DLOAD_VAR(effect, var, name, varType) \
+    var = nullptr;
+#else
 #define D3DLOAD_TECH(effect, tech, name) \
     tech = (effect)->GetTechniqueByName(name); \
     if (!(tech)->IsValid()) \
@@ -23,13 +32,40 @@
     var = (effect)->GetVariableByName(name)->varType(); \
     if (!(var)->IsValid()) \
         LOG(LEVEL_ERROR, "Variable " << (name) << " not found")
+#endif
+
+//Concrete material type, the software rasterizer specializes its shading kernels on it instead of calling Shade virtually
+enum class MaterialKind
+{
+    Flat = 0,
+    Mapped = 1
+};
+
+//Dense reference to a material registered with the MaterialManager, resolving it is a single array index.
+//The generation catches handles to a slot whose material was removed, even after the slot got reused.
+struct MaterialHandle
+{
+    static constexpr uint16_t InvalidIndex = 0xFFFF;
+
+    uint16_t index = InvalidIndex;
+    uint16_t generation = 0;
+
+    [[nodiscard]] constexpr auto IsValid() const noexcept -> bool { return index != InvalidIndex; }
+    //Sorting draws on this key groups them per material
+    [[nodiscard]] constexpr auto GetKey() const noexcept -> uint32_t { return static_cast<uint32_t>(index) << 16 | generation; }
+
+    [[nodiscard]] friend constexpr bool operator==(const MaterialHandle& a, const MaterialHandle& b) noexcept { return a.GetKey() == b.GetKey(); }
+    [[nodiscard]] friend constexpr bool operator<(const MaterialHandle& a, const MaterialHandle& b) noexcept { return a.GetKey() < b.GetKey(); }
+};
 
 class Material
 {
 public:
-    Material(ID3D11Device* pDevice, const std::wstring& effectFile, const std::string_view name, const bool hasTransparency = false)
+    Material(ID3D11Device* pDevice, const std::wstring& effectFile, const std::string_view name, const MaterialKind kind, const bool hasTransparency = false)
         : m_Name(name),
+          m_Kind(kind),
           m_HasTransparency(hasTransparency),
+          m_TextureFilter(TextureFilter::Point),
           m_pEffect(LoadEffect(pDevice, effectFile))
     {
         D3DLOAD_TECH(m_pEffect, m_pTechnique, "DefaultTechnique")
@@ -65,18 +101,36 @@ public:
     virtual void SetMatrices(const glm::mat4& projectionMat, const glm::mat4& viewMat, const glm::mat4& worldMat) = 0;
     virtual void SetScalars() = 0;
 
-    void UpdateTypeSettings(const HardwareRenderType& renderType, const HardwareFilterType& samplerType) const noexcept
+    void UpdateTypeSettings([[maybe_unused]] const HardwareRenderType& renderType, [[maybe_unused]] const HardwareFilterType& samplerType) noexcept
     {
+#ifndef HYBRID_HEADLESS
         m_pSamplerVariable->SetInt(magic_enum::enum_integer(samplerType));
         m_pRenderTypeVariable->SetInt(magic_enum::enum_integer(renderType));
+#endif
+
+        // The software samplers follow the hardware filter setting, D3D's linear sampler filters between mips as well
+        switch (samplerType)
+        {
+        case HardwareFilterType::Point:
+            m_TextureFilter = TextureFilter::Point;
+            break;
+        case HardwareFilterType::Linear:
+            m_TextureFilter = TextureFilter::Trilinear;
+            break;
+        case HardwareFilterType::Anisotropic:
+            m_TextureFilter = TextureFilter::Anisotropic;
+            break;
+        }
     }
 
     //Getters
     /*General*/
     [[nodiscard]] constexpr auto GetName() const noexcept -> std::string_view { return m_Name; }
+    [[nodiscard]] constexpr auto GetKind() const noexcept -> MaterialKind { return m_Kind; }
     [[nodiscard]] constexpr auto HasTransparency() const noexcept -> bool { return m_HasTransparency; }
 
     /*Software*/
+    [[nodiscard]] constexpr auto GetTextureFilter() const noexcept -> TextureFilter { return m_TextureFilter; }
     [[nodiscard]] virtual auto GetMappedNormal(const VertexOutput& v) const noexcept -> glm::vec3 { return v.normal; }
 
     /*D3D*/
@@ -89,7 +143,10 @@ public:
 protected:
     /*General*/
     std::string_view m_Name;
+    MaterialKind m_Kind;
     bool m_HasTransparency;
+    /*Software*/
+    TextureFilter m_TextureFilter;
     /*D3D*/
     ID3DX11Effect* m_pEffect; // "SHADER"
     ID3DX11EffectTechnique* m_pTechnique;
@@ -98,8 +155,11 @@ protected:
     ID3DX11EffectScalarVariable* m_pRenderTypeVariable;
 
     //Handles "SHADER" compilation
-    static ID3DX11Effect* LoadEffect(ID3D11Device* pDevice, const std::wstring& effectFile)
+    static ID3DX11Effect* LoadEffect([[maybe_unused]] ID3D11Device* pDevice, [[maybe_unused]] const std::wstring& effectFile)
     {
+#ifdef HYBRID_HEADLESS
+        return nullptr;
+#else
         HRESULT result = S_OK;
         ID3D10Blob* pErrorBlob = nullptr;
         ID3DX11Effect* pEffect;
@@ -146,6 +206,7 @@ protected:
             }
         }
         return pEffect;
+#endif
     }
 };
 
@@ -9,13 +9,14 @@
 class MaterialFlat final : public Material
 {
 public:
+    //Takes ownership of the map, it has to be loaded already (see TextureLoader)
     MaterialFlat(ID3D11Device* pDevice,
                  const std::wstring& effectPath,
-                 const std::string& diffusePath,
+                 Texture* pDiffuseMap,
                  const std::string_view name,
                  const bool hasTransparency = false)
-        : Material(pDevice, effectPath, name, hasTransparency),
-          m_pDiffuseMap(new Texture(pDevice, diffusePath))
+        : Material(pDevice, effectPath, name, MaterialKind::Flat, hasTransparency),
+          m_pDiffuseMap(pDiffuseMap)
     {
 
         D3DLOAD_VAR(m_pEffect, m_pDiffuseMapVariable, "gDiffuseMap", AsShaderResource)
@@ -33,23 +34,35 @@ public:
     DEL_ROF(MaterialFlat)
 
     //Workers
-    RGBColor Shade(const VertexOutput&, const glm::vec3&, const glm::vec3&, const glm::vec3&) const override { return RGBColor(0); }
+    /*Software*/
+    //Unlit diffuse like FlatTransparency.fx, the alpha is dropped
+    RGBColor Shade(const VertexOutput& v, const glm::vec3&, const glm::vec3&, const glm::vec3&) const override { return RGBColor(ShadeBlended(v)); }
+
+    //Unlit diffuse with the map's alpha as opacity, used by the blended software pass
+    [[nodiscard]] glm::vec4 ShadeBlended(const VertexOutput& v) const noexcept
+    {
+        return glm::clamp(m_pDiffuseMap->Sample4({v.uv, v.uvDx, v.uvDy, m_TextureFilter}), 0.f, 1.f);
+    }
 
     //Setters
     /*D3D*/
     void SetMaps() override
     {
+#ifndef HYBRID_HEADLESS
         if (m_pDiffuseMapVariable->IsValid())
             m_pDiffuseMapVariable->SetResource(m_pDiffuseMap->GetTextureView());
+#endif
     }
 
-    void SetMatrices(const glm::mat4& projectionMat, const glm::mat4& viewMat, const glm::mat4& worldMat) override
+    void SetMatrices([[maybe_unused]] const glm::mat4& projectionMat, [[maybe_unused]] const glm::mat4& viewMat, [[maybe_unused]] const glm::mat4& worldMat) override
     {
+#ifndef HYBRID_HEADLESS
         auto worldViewProjection = projectionMat * viewMat * worldMat;
         auto worldMatrix = worldMat;
 
         m_pMatWorldViewProjVariable->SetMatrix(&worldViewProjection[0][0]);
         m_pMatWorldVariable->SetMatrix(&worldMatrix[0][0]);
+#endif
     }
 
     void SetScalars() override
@@ -5,16 +5,70 @@
 
 MaterialManager::~MaterialManager()
 {
-    for (auto [id, pMat] : m_Materials)
+    for (auto& slot : m_Slots)
     {
-        SafeDelete(pMat);
+        SafeDelete(slot.pMaterial);
     }
 }
 
 #pragma region ExternalItemManipulation
-void MaterialManager::AddMaterial(Material* pMaterial)
+MaterialHandle MaterialManager::AddMaterial(Material* pMaterial)
 {
-    m_Materials.emplace(std::make_pair(pMaterial->GetName(), pMaterial));
+    if (const auto existing = m_Names.find(pMaterial->GetName()); existing != m_Names.end())
+    {
+        LOG(LEVEL_ERROR, "Material " << pMaterial->GetName() << " is already registered")
+        SafeDelete(pMaterial);
+        return existing->second;
+    }
+
+    MaterialHandle handle{};
+    if (!m_FreeSlots.empty())
+    {
+        handle.index = m_FreeSlots.back();
+        m_FreeSlots.pop_back();
+    }
+    else if (m_Slots.size() < MaterialHandle::InvalidIndex)
+    {
+        handle.index = static_cast<uint16_t>(m_Slots.size());
+        m_Slots.emplace_back();
+    }
+    else
+    {
+        LOG(LEVEL_ERROR, "Out of material slots, " << pMaterial->GetName() << " was not registered")
+        SafeDelete(pMaterial);
+        return handle;
+    }
+
+    auto& slot = m_Slots[handle.index];
+    slot.pMaterial = pMaterial;
+    handle.generation = slot.generation;
+
+    m_Names.emplace(pMaterial->GetName(), handle);
+    return handle;
+}
+
+void MaterialManager::RemoveMaterial(const MaterialHandle handle)
+{
+    auto* pMaterial = GetMaterial(handle);
+    if (pMaterial == nullptr)
+        return;
+
+    m_Names.erase(pMaterial->GetName());
+
+    // Bumping the generation invalidates every handle that still points at this slot
+    auto& slot = m_Slots[handle.index];
+    delete slot.pMaterial;
+    slot.pMaterial = nullptr;
+    ++slot.generation;
+    m_FreeSlots.push_back(handle.index);
+}
+#pragma endregion
+
+#pragma region Getters
+MaterialHandle MaterialManager::GetHandle(const std::string_view name) const noexcept
+{
+    const auto it = m_Names.find(name);
+    return it != m_Names.end() ? it->second : MaterialHandle{};
 }
 #pragma endregion
 
@@ -3,6 +3,7 @@
 
 //Standard Includes
 #include <unordered_map>
+#include <vector>
 
 // Project Includes
 #include "Helpers/Singleton.hpp"
@@ -17,6 +18,13 @@ enum SamplerType
     SamplerSize = 3
 };
 
+struct MaterialSlot
+{
+    Material* pMaterial = nullptr; // nullptr while the slot is free
+    uint16_t generation = 0;
+};
+
+//Owns every material. The render loop refers to them by MaterialHandle; lookups by name are kept for tooling and setup.
 class MaterialManager final : public Singleton<MaterialManager>
 {
 public:
@@ -25,20 +33,31 @@ public:
     DEL_ROF(MaterialManager)
 
     //External Item Manipulation
-    void AddMaterial(Material* pMaterial);
+    MaterialHandle AddMaterial(Material* pMaterial);
+    void RemoveMaterial(MaterialHandle handle);
 
     //Getters
-    [[nodiscard]] constexpr auto GetMaterials() noexcept -> std::unordered_map<std::string_view, Material*>& { return m_Materials; }
-    [[nodiscard]] auto GetMaterial(const std::string_view name) const noexcept -> Material* { return m_Materials.at(name); }
-    [[nodiscard]] auto GetMaterial(Mesh* pObject) const noexcept -> Material* { return GetMaterial(pObject->GetMaterialName()); }
-    [[nodiscard]] auto AmountOfMaterials() const noexcept -> uint32_t { return static_cast<uint32_t>(m_Materials.size()); }
+    [[nodiscard]] constexpr auto GetMaterials() const noexcept -> const std::vector<MaterialSlot>& { return m_Slots; }
+    //Returns nullptr for a stale or invalid handle
+    [[nodiscard]] auto GetMaterial(const MaterialHandle handle) const noexcept -> Material*
+    {
+        if (handle.index >= m_Slots.size() || m_Slots[handle.index].generation != handle.generation)
+            return nullptr;
+        return m_Slots[handle.index].pMaterial;
+    }
+    [[nodiscard]] auto GetMaterial(const std::string_view name) const noexcept -> Material* { return GetMaterial(GetHandle(name)); }
+    [[nodiscard]] auto GetMaterial(const Mesh* pObject) const noexcept -> Material* { return GetMaterial(pObject->GetMaterialHandle()); }
+    [[nodiscard]] auto GetHandle(std::string_view name) const noexcept -> MaterialHandle;
+    [[nodiscard]] auto AmountOfMaterials() const noexcept -> uint32_t { return static_cast<uint32_t>(m_Names.size()); }
 
     //Workers
 
 private:
 
     //Data Members
-    std::unordered_map<std::string_view, Material*> m_Materials;
+    std::vector<MaterialSlot> m_Slots;
+    std::vector<uint16_t> m_FreeSlots;
+    std::unordered_map<std::string_view, MaterialHandle> m_Names;
 
     SamplerType m_SamplerType;
 };
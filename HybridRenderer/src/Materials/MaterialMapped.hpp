@@ -5,22 +5,29 @@
 //Project includes
 #include "Materials/Material.hpp"
 #include "Materials/BRDF.hpp"
+#include "Materials/InterleavedTexture.hpp"
 #include "Materials/Texture.hpp"
 #include "Rendering/Camera.hpp"
 #include <glm/gtc/matrix_access.hpp>
 class MaterialMapped final : public Material
 {
 public:
-    MaterialMapped(ID3D11Device* pDevice, const std::wstring& effectPath, const std::string& diffusePath,
-                   const std::string& normalPath, const std::string& glossPath, const std::string& specularPath,
-                   const float shininess, const std::string_view name, const bool hasTransparency = false)
-        : Material(pDevice, effectPath, name, hasTransparency),
-          m_pDiffuseMap(new Texture(pDevice, diffusePath)),
-          m_pNormalMap(new Texture(pDevice, normalPath)),
-          m_pGlossinessMap(new Texture(pDevice, glossPath)),
-          m_pSpecularMap(new Texture(pDevice, specularPath)),
+    //Takes ownership of the maps, they have to be loaded already (see TextureLoader::Queue and QueueInterleaved)
+    MaterialMapped(ID3D11Device* pDevice, const std::wstring& effectPath, Texture* pDiffuseMap,
+                   Texture* pNormalMap, Texture* pGlossinessMap, Texture* pSpecularMap,
+                   const float shininess, const std::string_view name, const bool hasTransparency = false, InterleavedTexture* pInterleavedMaps = nullptr)
+        : Material(pDevice, effectPath, name, MaterialKind::Mapped, hasTransparency),
+          m_pDiffuseMap(pDiffuseMap),
+          m_pNormalMap(pNormalMap),
+          m_pGlossinessMap(pGlossinessMap),
+          m_pSpecularMap(pSpecularMap),
+          m_pInterleavedMaps(pInterleavedMaps),
           m_Shininess(shininess)
     {
+        // One texel fetch for all four maps in software, D3D keeps sampling the separate textures
+        if (m_pInterleavedMaps != nullptr && !m_pInterleavedMaps->IsValid())
+            SafeDelete(m_pInterleavedMaps);
+
         D3DLOAD_VAR(m_pEffect, m_pDiffuseMapVariable, "gDiffuseMap", AsShaderResource)
         D3DLOAD_VAR(m_pEffect, m_pNormalMapVariable, "gNormalMap", AsShaderResource)
         D3DLOAD_VAR(m_pEffect, m_pGlossinessMapVariable, "gGlossinessMap", AsShaderResource)
@@ -54,6 +61,7 @@ public:
         SafeDelete(m_pNormalMap);
         SafeDelete(m_pGlossinessMap);
         SafeDelete(m_pSpecularMap);
+        SafeDelete(m_pInterleavedMaps);
     }
 
     DEL_ROF(MaterialMapped)
@@ -62,43 +70,22 @@ public:
     /*Software*/
     RGBColor Shade(const VertexOutput& v, const glm::vec3& lightDir, const glm::vec3&, const glm::vec3&) const override
     {
-        const auto pCam = SceneGraph::GetCamera();
-        const auto viewDirection = glm::normalize(v.worldPos - pCam->GetPosition());
-    
-        RGBColor finalColor = {0.f, 0.f, 0.f};
-        // variables
-        const glm::vec3 lightDirection = {0.577f, -0.577f, -0.577f};
+        // all maps are read with the same footprint
+        const SampleFootprint footprint{v.uv, v.uvDx, v.uvDy, m_TextureFilter};
 
-        const auto lightIntensity = 7.f;
-        const RGBColor lightColor = {1.f, 1.f, 1.f};
+        if (m_pInterleavedMaps != nullptr)
+        {
+            const auto texel = m_pInterleavedMaps->Sample(footprint);
+            return ShadeTexel(v, lightDir, ToWorldNormal(v, texel.GetNormal()), texel.diffuse, texel.specular, texel.gloss);
+        }
 
         // normal
         const auto mappedNormal = GetMappedNormal(v);
 
-        // diffuse
-        RGBColor diffuseColor{0.f};
-        if (m_pDiffuseMap!= nullptr)
-        {
-            float diffuseStrength = pow((glm::dot(-mappedNormal, lightDir) * 0.5f) + 0.5f, 2.f);
-            //auto diffuseStrength = glm::dot(-mappedNormal, lightDirection);
-            diffuseStrength = std::max(0.f, diffuseStrength);
-            diffuseStrength /= glm::pi<float>();
-            diffuseStrength *= lightIntensity;
-            diffuseColor = lightColor * m_pDiffuseMap->Sample(v.uv) * diffuseStrength;
-        }
-
-        // phong
-        RGBColor specularColor{0.f};
+        const auto diffuse = m_pDiffuseMap != nullptr ? m_pDiffuseMap->Sample(footprint) : RGBColor{0.f};
         if (m_pSpecularMap != nullptr && m_pGlossinessMap != nullptr)
-        {
-            specularColor = BRDF::Phong(m_pSpecularMap->Sample(v.uv), m_pGlossinessMap->SampleF(v.uv) * m_Shininess, lightDir, -v.viewDirection, mappedNormal);
-        }
-
-        finalColor = diffuseColor + specularColor;
-
-        MaxToOne(finalColor);
-
-        return finalColor;
+            return ShadeTexel(v, lightDir, mappedNormal, diffuse, m_pSpecularMap->Sample(footprint), m_pGlossinessMap->SampleF(footprint));
+        return ShadeTexel(v, lightDir, mappedNormal, diffuse, RGBColor{0.f}, 0.f);
 
 
         
@@ -116,6 +103,7 @@ public:
     /*D3D*/
     void SetMaps() override
     {
+#ifndef HYBRID_HEADLESS
         if (m_pDiffuseMapVariable->IsValid())
             m_pDiffuseMapVariable->SetResource(m_pDiffuseMap->GetTextureView());
         if (m_pNormalMapVariable->IsValid())
@@ -124,10 +112,12 @@ public:
             m_pGlossinessMapVariable->SetResource(m_pGlossinessMap->GetTextureView());
         if (m_pSpecularMapVariable->IsValid())
             m_pSpecularMapVariable->SetResource(m_pSpecularMap->GetTextureView());
+#endif
     }
 
-    void SetMatrices(const glm::mat4& projectionMat, const glm::mat4& viewMat, const glm::mat4& worldMat) override
+    void SetMatrices([[maybe_unused]] const glm::mat4& projectionMat, [[maybe_unused]] const glm::mat4& viewMat, [[maybe_unused]] const glm::mat4& worldMat) override
     {
+#ifndef HYBRID_HEADLESS
         auto worldViewProjection = projectionMat * viewMat * worldMat;
         auto worldMatrix = worldMat;
         auto inverseViewMatrix = glm::inverse(viewMat);
@@ -135,28 +125,27 @@ public:
         m_pMatWorldViewProjVariable->SetMatrix(&worldViewProjection[0][0]);
         m_pMatWorldVariable->SetMatrix(&worldMatrix[0][0]);
         m_pMatInverseViewVariable->SetMatrix(&inverseViewMatrix[0][0]);
+#endif
     }
 
     void SetScalars() override
     {
+#ifndef HYBRID_HEADLESS
         m_pShininessVariable->SetFloat(m_Shininess);
+#endif
     }
 
     //Getters
     /*Software*/
     glm::vec3 GetMappedNormal(const VertexOutput& v) const noexcept override
     {
+        const SampleFootprint footprint{v.uv, v.uvDx, v.uvDy, m_TextureFilter};
+        if (m_pInterleavedMaps != nullptr)
+            return ToWorldNormal(v, m_pInterleavedMaps->Sample(footprint).GetNormal());
         if (m_pNormalMap == nullptr)
             return v.normal;
 
-        const auto binormal = glm::cross(v.tangent, v.normal);
-        const auto tangentSpaceAxis = glm::mat3(v.tangent, binormal, v.normal);
-        auto mappedNormal = m_pNormalMap->SampleV(v.uv);
-        mappedNormal /= 255.f;
-        mappedNormal = 2.f * mappedNormal - 1.f;
-        mappedNormal = tangentSpaceAxis * mappedNormal;
-
-        return glm::normalize(mappedNormal);
+        return ToWorldNormal(v, m_pNormalMap->SampleNormal(footprint));
     }
 
 private:
@@ -165,8 +154,38 @@ private:
     Texture* m_pNormalMap;
     Texture* m_pGlossinessMap;
     Texture* m_pSpecularMap;
+    InterleavedTexture* m_pInterleavedMaps; // nullptr unless the maps are interleaved
     float m_Shininess;
 
+    /*Software*/
+    //Lights the sampled maps, shared by the separate and interleaved paths
+    RGBColor ShadeTexel(const VertexOutput& v, const glm::vec3& lightDir, const glm::vec3& mappedNormal, const RGBColor& diffuse, const RGBColor& specular, const float gloss) const noexcept
+    {
+        const auto lightIntensity = 7.f;
+        const RGBColor lightColor = {1.f, 1.f, 1.f};
+
+        // diffuse
+        float diffuseStrength = pow((glm::dot(-mappedNormal, lightDir) * 0.5f) + 0.5f, 2.f);
+        diffuseStrength = std::max(0.f, diffuseStrength);
+        diffuseStrength /= glm::pi<float>();
+        diffuseStrength *= lightIntensity;
+        const auto diffuseColor = lightColor * diffuse * diffuseStrength;
+
+        // phong
+        const auto specularColor = BRDF::Phong(specular, gloss * m_Shininess, lightDir, -v.viewDirection, mappedNormal);
+
+        RGBColor finalColor = diffuseColor + specularColor;
+        MaxToOne(finalColor);
+        return finalColor;
+    }
+
+    static glm::vec3 ToWorldNormal(const VertexOutput& v, const glm::vec3& tangentNormal) noexcept
+    {
+        const auto binormal = glm::cross(v.tangent, v.normal);
+        const auto tangentSpaceAxis = glm::mat3(v.tangent, binormal, v.normal);
+        return glm::normalize(tangentSpaceAxis * tangentNormal);
+    }
+
     /*D3D*/
     ID3DX11EffectShaderResourceVariable* m_pDiffuseMapVariable;
     ID3DX11EffectShaderResourceVariable* m_pNormalMapVariable;
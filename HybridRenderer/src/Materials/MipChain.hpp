@@ -0,0 +1,238 @@
+#ifndef MIP_CHAIN_HPP
+#define MIP_CHAIN_HPP
+
+//Standard includes
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+//Project includes
+#include "Helpers/MathHelpers.hpp"
+
+//Software texture filtering, Point, Trilinear and Anisotropic match the Point, Linear and Anisotropic hardware samplers
+enum class TextureFilter
+{
+    Point = 0,      //Nearest texel of the nearest mip
+    Bilinear = 1,   //2x2 texels of the nearest mip
+    Trilinear = 2,  //Bilinear on the two mips around the LOD, blended
+    Anisotropic = 3 //Up to MaxAnisotropy trilinear taps along the longest axis of the pixel footprint
+};
+
+//Everything a filtered lookup needs: the uv, its screen space derivatives and the filter to apply
+struct SampleFootprint
+{
+    glm::vec2 uv;
+    glm::vec2 uvDx;
+    glm::vec2 uvDy;
+    TextureFilter filter;
+};
+
+//Mip selection and filtering shared by the software texture layouts.
+//Levels only need a width and height, fetch(mip, x, y) returns the decoded texel, filtering blends decoded values (+, - and * float).
+namespace MipFilter
+{
+    constexpr uint32_t MaxAnisotropy = 16;
+
+    template <typename Decoded, typename Level, typename Fetch>
+    [[nodiscard]] Decoded SamplePoint(const std::vector<Level>& levels, const glm::vec2& uv, const uint32_t mip, const Fetch& fetch) noexcept
+    {
+        const auto& level = levels[mip];
+        const auto x = std::min(static_cast<uint32_t>(glm::clamp(uv.x, 0.f, 1.f) * static_cast<float>(level.width)), level.width - 1);
+        const auto y = std::min(static_cast<uint32_t>(glm::clamp(uv.y, 0.f, 1.f) * static_cast<float>(level.height)), level.height - 1);
+        return fetch(mip, x, y);
+    }
+
+    template <typename Decoded, typename Level, typename Fetch>
+    [[nodiscard]] Decoded SampleBilinear(const std::vector<Level>& levels, const glm::vec2& uv, const uint32_t mip, const Fetch& fetch) noexcept
+    {
+        const auto& level = levels[mip];
+
+        // Texel centers sit at .5, the 2x2 footprint is clamped to the edge
+        const auto texelX = glm::clamp(uv.x, 0.f, 1.f) * static_cast<float>(level.width) - 0.5f;
+        const auto texelY = glm::clamp(uv.y, 0.f, 1.f) * static_cast<float>(level.height) - 0.5f;
+        const auto floorX = std::floor(texelX);
+        const auto floorY = std::floor(texelY);
+        const auto fractionX = texelX - floorX;
+        const auto fractionY = texelY - floorY;
+
+        const auto maxX = static_cast<int32_t>(level.width) - 1;
+        const auto maxY = static_cast<int32_t>(level.height) - 1;
+        const auto x0 = static_cast<uint32_t>(std::clamp(static_cast<int32_t>(floorX), 0, maxX));
+        const auto x1 = static_cast<uint32_t>(std::clamp(static_cast<int32_t>(floorX) + 1, 0, maxX));
+        const auto y0 = static_cast<uint32_t>(std::clamp(static_cast<int32_t>(floorY), 0, maxY));
+        const auto y1 = static_cast<uint32_t>(std::clamp(static_cast<int32_t>(floorY) + 1, 0, maxY));
+
+        const auto lerp = [](const Decoded& a, const Decoded& b, const float t) { return a + (b - a) * t; };
+        const auto top = lerp(fetch(mip, x0, y0), fetch(mip, x1, y0), fractionX);
+        const auto bottom = lerp(fetch(mip, x0, y1), fetch(mip, x1, y1), fractionX);
+        return lerp(top, bottom, fractionY);
+    }
+
+    template <typename Decoded, typename Level, typename Fetch>
+    [[nodiscard]] Decoded SampleTrilinear(const std::vector<Level>& levels, const glm::vec2& uv, const float lod, const Fetch& fetch) noexcept
+    {
+        const auto mip = static_cast<uint32_t>(lod);
+        const auto blend = lod - static_cast<float>(mip);
+        const auto nearSample = SampleBilinear<Decoded>(levels, uv, mip, fetch);
+        if (blend <= 0.f || mip + 1 >= levels.size())
+            return nearSample;
+        return nearSample + (SampleBilinear<Decoded>(levels, uv, mip + 1, fetch) - nearSample) * blend;
+    }
+
+    template <typename Decoded, typename Level, typename Fetch>
+    [[nodiscard]] Decoded Filter(const std::vector<Level>& levels, const SampleFootprint& footprint, const Fetch& fetch) noexcept
+    {
+        // Footprint of the pixel in mip 0 texels
+        const auto& base = levels.front();
+        const auto size = glm::vec2(static_cast<float>(base.width), static_cast<float>(base.height));
+        const auto lengthX = glm::length(footprint.uvDx * size);
+        const auto lengthY = glm::length(footprint.uvDy * size);
+
+        // Written so a NaN LOD ends up on mip 0
+        const auto maxLod = static_cast<float>(levels.size() - 1);
+        const auto clampLod = [maxLod](const float lod) { return lod > 0.f ? std::min(lod, maxLod) : 0.f; };
+
+        switch (footprint.filter)
+        {
+        case TextureFilter::Point:
+            return SamplePoint<Decoded>(levels, footprint.uv, static_cast<uint32_t>(clampLod(std::log2(std::max(lengthX, lengthY))) + 0.5f), fetch);
+        case TextureFilter::Bilinear:
+            return SampleBilinear<Decoded>(levels, footprint.uv, static_cast<uint32_t>(clampLod(std::log2(std::max(lengthX, lengthY))) + 0.5f), fetch);
+        case TextureFilter::Trilinear:
+            return SampleTrilinear<Decoded>(levels, footprint.uv, clampLod(std::log2(std::max(lengthX, lengthY))), fetch);
+        case TextureFilter::Anisotropic:
+        {
+            // Taps spread along the long axis cover the footprint's length, so the LOD only has to cover its width
+            const auto majorLength = std::max(lengthX, lengthY);
+            const auto ratio = majorLength / std::max(std::min(lengthX, lengthY), 1e-8f);
+            const auto tapCount = ratio > 1.f ? static_cast<uint32_t>(std::min(std::ceil(ratio), static_cast<float>(MaxAnisotropy))) : 1u;
+            const auto lod = clampLod(std::log2(majorLength / static_cast<float>(tapCount)));
+            if (tapCount == 1)
+                return SampleTrilinear<Decoded>(levels, footprint.uv, lod, fetch);
+
+            const auto majorAxis = lengthX >= lengthY ? footprint.uvDx : footprint.uvDy;
+            const auto tapStep = 1.f / static_cast<float>(tapCount);
+            auto result = SampleTrilinear<Decoded>(levels, footprint.uv + majorAxis * (0.5f * tapStep - 0.5f), lod, fetch);
+            for (uint32_t tap = 1; tap < tapCount; ++tap)
+            {
+                result = result + SampleTrilinear<Decoded>(levels, footprint.uv + majorAxis * ((static_cast<float>(tap) + 0.5f) * tapStep - 0.5f), lod, fetch);
+            }
+            return result * tapStep;
+        }
+        }
+        return SamplePoint<Decoded>(levels, footprint.uv, 0, fetch);
+    }
+}
+
+//Mip levels of a texture, texels are stored in tiles of exactly one cache line so neighbouring samples along either axis share lines.
+//Texel is the stored encoding, filtering decodes texels with MipFilter.
+template <typename Texel>
+class MipChain final
+{
+public:
+    static constexpr uint32_t CacheLineSize = 64;
+    static constexpr uint32_t TileWidth = 4;
+    static constexpr uint32_t TileHeight = CacheLineSize / (TileWidth * sizeof(Texel));
+    static_assert(TileHeight > 0 && TileWidth * TileHeight * sizeof(Texel) == CacheLineSize, "A tile has to fill a cache line exactly");
+
+    struct MipLevel
+    {
+        uint32_t width;
+        uint32_t height;
+        uint32_t tilesX;
+        uint32_t firstTexel; // offset of the level in the texel array
+    };
+
+    //Lays out every level down to 1x1, texels are zeroed
+    void Allocate(const uint32_t width, const uint32_t height)
+    {
+        m_Levels.clear();
+        uint32_t texelCount = 0;
+        auto levelWidth = std::max(1u, width);
+        auto levelHeight = std::max(1u, height);
+        while (true)
+        {
+            // Edge tiles are padded, the samplers clamp before addressing so the padding is never read
+            const MipLevel level{levelWidth, levelHeight, (levelWidth + TileWidth - 1) / TileWidth, texelCount};
+            texelCount += level.tilesX * ((levelHeight + TileHeight - 1) / TileHeight) * TileWidth * TileHeight;
+            m_Levels.push_back(level);
+
+            if (levelWidth == 1 && levelHeight == 1)
+                break;
+            levelWidth = std::max(1u, levelWidth / 2);
+            levelHeight = std::max(1u, levelHeight / 2);
+        }
+        m_Texels.assign(texelCount, Texel{});
+    }
+
+    /**
+     * Builds the whole chain from linear mip 0 texels
+     * @param average combines 4 texels into 1, every level is a 2x2 box filter of the previous one. Odd sizes repeat their last row or column.
+     * */
+    template <typename Average>
+    void Build(const std::vector<Texel>& baseTexels, const uint32_t width, const uint32_t height, const Average& average)
+    {
+        Allocate(width, height);
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                SetTexel(0, x, y, baseTexels[x + y * width]);
+            }
+        }
+
+        for (uint32_t mip = 1; mip < GetMipCount(); ++mip)
+        {
+            const auto& previous = m_Levels[mip - 1];
+            const auto& level = m_Levels[mip];
+            for (uint32_t y = 0; y < level.height; ++y)
+            {
+                const auto y0 = std::min(2 * y, previous.height - 1);
+                const auto y1 = std::min(2 * y + 1, previous.height - 1);
+                for (uint32_t x = 0; x < level.width; ++x)
+                {
+                    const auto x0 = std::min(2 * x, previous.width - 1);
+                    const auto x1 = std::min(2 * x + 1, previous.width - 1);
+                    SetTexel(mip, x, y, average(GetTexel(mip - 1, x0, y0), GetTexel(mip - 1, x1, y0), GetTexel(mip - 1, x0, y1), GetTexel(mip - 1, x1, y1)));
+                }
+            }
+        }
+    }
+
+    /**
+     * Filters the chain at a footprint
+     * @param decode turns a stored texel into a Decoded, filtering happens on the decoded values
+     * */
+    template <typename Decoded, typename Decode>
+    [[nodiscard]] Decoded Filter(const SampleFootprint& footprint, const Decode& decode) const noexcept
+    {
+        return MipFilter::Filter<Decoded>(m_Levels, footprint, [this, &decode](const uint32_t mip, const uint32_t x, const uint32_t y)
+        {
+            return decode(m_Texels[GetTexelIndex(m_Levels[mip], x, y)]);
+        });
+    }
+
+    //Setters
+    void SetTexel(const uint32_t mip, const uint32_t x, const uint32_t y, const Texel& texel) noexcept { m_Texels[GetTexelIndex(m_Levels[mip], x, y)] = texel; }
+
+    //Getters
+    [[nodiscard]] auto GetTexel(const uint32_t mip, const uint32_t x, const uint32_t y) const noexcept -> Texel { return m_Texels[GetTexelIndex(m_Levels[mip], x, y)]; }
+    [[nodiscard]] auto GetLevel(const uint32_t mip) const noexcept -> const MipLevel& { return m_Levels[mip]; }
+    [[nodiscard]] auto GetMipCount() const noexcept -> uint32_t { return static_cast<uint32_t>(m_Levels.size()); }
+    //Raw texels of every level, what the texture cache reads and writes
+    [[nodiscard]] auto GetStorage() noexcept -> std::vector<Texel>& { return m_Texels; }
+    [[nodiscard]] auto GetStorage() const noexcept -> const std::vector<Texel>& { return m_Texels; }
+
+private:
+    std::vector<MipLevel> m_Levels;
+    std::vector<Texel> m_Texels;
+
+    [[nodiscard]] static constexpr uint32_t GetTexelIndex(const MipLevel& level, const uint32_t x, const uint32_t y) noexcept
+    {
+        const auto tileIdx = (y / TileHeight) * level.tilesX + x / TileWidth;
+        return level.firstTexel + tileIdx * TileWidth * TileHeight + (y % TileHeight) * TileWidth + x % TileWidth;
+    }
+};
+
+#endif // !MIP_CHAIN_HPP
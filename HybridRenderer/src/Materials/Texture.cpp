@@ -1,111 +1,202 @@
 #include "pch.h"
 #include "Materials/Texture.hpp"
-#include <SDL_image.h>
+#include <cstring>
 
-Texture::Texture(ID3D11Device* pDevice, const std::string& filePath)
-	: m_pSurface(IMG_Load(filePath.c_str()))
+#include "Debugging/Logger.hpp"
+#include "Helpers/magic_enum.hpp"
+#include "Materials/TextureCache.hpp"
+
+Texture::Texture(std::string filePath, const TextureUsage usage)
+	: m_FilePath(std::move(filePath))
+	, m_Usage(usage)
+	, m_Format(TextureFormat::RGBA8)
 	, m_pTexture(nullptr)
 	, m_pTextureResourceView(nullptr)
-
 {
-	LoadTexture(pDevice, m_pSurface);
+	// Fallback until decoded or for a texture that fails to load, a single white texel
+	m_Mips.Build({0xFFFFFFFF}, 1, 1, [](const uint32_t a, uint32_t, uint32_t, uint32_t) { return a; });
 }
 
 Texture::~Texture()
 {
-	if (m_pTextureResourceView)
-		m_pTextureResourceView->Release();
-	if (m_pTexture)
-		m_pTexture->Release();
-	if (m_pSurface != nullptr)
-		SDL_FreeSurface(m_pSurface);
+	SafeRelease(m_pTextureResourceView);
+	SafeRelease(m_pTexture);
 }
 
 #pragma region Software
-
-RGBColor Texture::Sample(const glm::vec2& uv) const
+void Texture::Decode()
 {
-	glm::vec2 remappedUV;
-
-	remappedUV.x = glm::clamp(uv.x, 0.f, 1.f) * m_pSurface->w;
-	remappedUV.y = glm::clamp(uv.y, 0.f, 1.f) * m_pSurface->h;
-	SDL_Color color;
-
-	SDL_GetRGB(GetPixel(m_pSurface, static_cast<uint32_t>(remappedUV.x), static_cast<uint32_t>(remappedUV.y)), m_pSurface->format, &color.r, &color.g, &color.b);
+	// Every texture is brought to RGBA8 once, both the D3D upload and the software texels rely on that layout
+	if (ImageIO::Load(m_FilePath, m_DecodedImage))
+		ConvertTexels(m_DecodedImage);
+}
 
-	return { color.r / 255.f, color.g / 255.f, color.b / 255.f };
+RGBColor Texture::Sample(const SampleFootprint& footprint) const noexcept
+{
+	return RGBColor(Filter(footprint));
 }
-glm::vec4 Texture::Sample4(const glm::vec2& uv) const
+
+glm::vec4 Texture::Sample4(const SampleFootprint& footprint) const noexcept
 {
-	glm::vec2 remappedUV;
+	return Filter(footprint);
+}
 
-	remappedUV.x = glm::clamp(uv.x, 0.f, 1.f) * m_pSurface->w;
-	remappedUV.y = glm::clamp(uv.y, 0.f, 1.f) * m_pSurface->h;
-	SDL_Color color;
+float Texture::SampleF(const SampleFootprint& footprint, const int32_t component) const noexcept
+{
+	return Filter(footprint)[std::clamp(component, 0, 3)];
+}
 
-	SDL_GetRGBA(GetPixel(m_pSurface, static_cast<uint32_t>(remappedUV.x), static_cast<uint32_t>(remappedUV.y)), m_pSurface->format, &color.r, &color.g, &color.b, &color.a);
+glm::vec3 Texture::SampleNormal(const SampleFootprint& footprint) const noexcept
+{
+	const auto texel = Filter(footprint);
+	if (m_Format != TextureFormat::BC5)
+		return glm::vec3(texel) * 2.f - 1.f;
 
-	return { color.r / 255.f, color.g / 255.f, color.b / 255.f, color.a / 255.f };
+	// BC5 only holds x and y, z is rebuilt after filtering so the result stays unit length
+	const auto normal = glm::vec2(texel) * 2.f - 1.f;
+	return {normal, std::sqrt(std::max(0.f, 1.f - glm::dot(normal, normal)))};
 }
 
-glm::vec3 Texture::SampleV(const glm::vec2& uv) const
+uint32_t Texture::GetTexel(const uint32_t mip, const uint32_t x, const uint32_t y) const noexcept
 {
-	glm::vec2 remappedUV;
-
-	remappedUV.x = glm::clamp(uv.x, 0.f, 1.f) * m_pSurface->w;
-	remappedUV.y = glm::clamp(uv.y, 0.f, 1.f) * m_pSurface->h;
-	SDL_Color color;
+	glm::vec4 texel;
+	const auto* pBlock = m_Format == TextureFormat::RGBA8 ? nullptr : m_Blocks.GetBlock(mip, x, y);
+	const auto texelIdx = BlockMipChain::GetTexelInBlock(x, y);
+	switch (m_Format)
+	{
+	case TextureFormat::BC1:
+		texel = DecodeBlockTexel<TextureFormat::BC1>(pBlock, texelIdx);
+		break;
+	case TextureFormat::BC4:
+		texel = DecodeBlockTexel<TextureFormat::BC4>(pBlock, texelIdx);
+		break;
+	case TextureFormat::BC5:
+		texel = DecodeBlockTexel<TextureFormat::BC5>(pBlock, texelIdx);
+		break;
+	case TextureFormat::RGBA8:
+	default:
+		return m_Mips.GetTexel(mip, x, y);
+	}
 
-	SDL_GetRGB(GetPixel(m_pSurface, static_cast<int32_t>(remappedUV.x), static_cast<int32_t>(remappedUV.y)), m_pSurface->format, &color.r, &color.g, &color.b);
+	const auto bytes = glm::uvec4(glm::clamp(texel, 0.f, 1.f) * 255.f + 0.5f);
+	return bytes.r | bytes.g << 8 | bytes.b << 16 | bytes.a << 24;
+}
 
-	return { color.r, color.g, color.b };
+glm::vec4 Texture::Filter(const SampleFootprint& footprint) const noexcept
+{
+	switch (m_Format)
+	{
+	case TextureFormat::BC1:
+		return m_Blocks.Filter<glm::vec4>(footprint, DecodeBlockTexel<TextureFormat::BC1>);
+	case TextureFormat::BC4:
+		return m_Blocks.Filter<glm::vec4>(footprint, DecodeBlockTexel<TextureFormat::BC4>);
+	case TextureFormat::BC5:
+		return m_Blocks.Filter<glm::vec4>(footprint, DecodeBlockTexel<TextureFormat::BC5>);
+	case TextureFormat::RGBA8:
+	default:
+		return m_Mips.Filter<glm::vec4>(footprint, Unpack);
+	}
 }
-float Texture::SampleF(const glm::vec2& uv, const int32_t component) const
+
+TextureFormat Texture::SelectFormat(const ImageIO::Image& image) const noexcept
 {
-	switch (component)
+	switch (m_Usage)
 	{
-	case 0:
-		return Sample(uv).r;
-	case 1:
-		return Sample(uv).g;
-	case 2:
-		return Sample(uv).b;
+	case TextureUsage::Normal:
+		return TextureFormat::BC5;
+	// Scalar maps keep only their red channel and sample as grey. Specular maps are read as an RGB tint by the shading,
+	// so they are only queued as scalar when they are grey anyway, like the vehicle's. D3D uploads the full image either way
+	case TextureUsage::Scalar:
+		return TextureFormat::BC4;
+	case TextureUsage::Color:
 	default:
-		return Sample(uv).r;
+		break;
 	}
+
+	// BC1 has no room for alpha, textures with translucent texels stay RGBA8
+	const auto isTranslucent = std::any_of(image.texels.begin(), image.texels.end(), [](const uint32_t texel) { return (texel >> 24) != 0xFF; });
+	return isTranslucent ? TextureFormat::RGBA8 : TextureFormat::BC1;
 }
 
-// GetPixel function adapted from http://sdl.beuc.net/sdl.wiki/Pixel_Access
-uint32_t Texture::GetPixel(SDL_Surface* surface, const uint32_t x, const uint32_t y)
+void Texture::ConvertTexels(const ImageIO::Image& image)
 {
-	const int32_t bpp = surface->format->BytesPerPixel;
-
-	auto* p = static_cast<uint8_t*>(surface->pixels) + y * surface->pitch + x * bpp;
-
-	switch (bpp) {
-	case 1:
-		return *p;
-	case 2:
-		return *reinterpret_cast<uint16_t*>(p);
-	case 3:
-		if constexpr (SDL_BYTEORDER == SDL_BIG_ENDIAN)
-			return p[0] << 16 | p[1] << 8 | p[2];
-		else
-			return p[0] | p[1] << 8 | p[2] << 16;
-	case 4:
-		return *reinterpret_cast<uint32_t*>(p);
+	const auto width = image.width;
+	const auto height = image.height;
+
+	// Compressed textures come from the cache when it is still up to date, compressing is by far the slowest part of loading
+	m_Format = SelectFormat(image);
+	const auto cacheFormat = m_Format == TextureFormat::BC1 ? TextureCache::Format::BC1 : m_Format == TextureFormat::BC4 ? TextureCache::Format::BC4 : TextureCache::Format::BC5;
+	const auto cachePath = TextureCache::GetPath(m_FilePath, magic_enum::enum_name(m_Format));
+	if (m_Format != TextureFormat::RGBA8)
+	{
+		m_Blocks = BlockMipChain(m_Format == TextureFormat::BC5 ? 2 : 1);
+		if (TextureCache::LoadChain(cachePath, cacheFormat, {m_FilePath}, m_Blocks) && m_Blocks.GetLevel(0).width == width && m_Blocks.GetLevel(0).height == height)
+		{
+			m_Mips = MipChain<uint32_t>{};
+			return;
+		}
+	}
+
+	// Rounded average of every byte of 4 texels
+	const auto average = [](const uint32_t a, const uint32_t b, const uint32_t c, const uint32_t d)
+	{
+		uint32_t result = 0;
+		for (uint32_t shift = 0; shift < 32; shift += 8)
+		{
+			const auto sum = (a >> shift & 0xFF) + (b >> shift & 0xFF) + (c >> shift & 0xFF) + (d >> shift & 0xFF);
+			result |= (sum + 2) / 4 << shift;
+		}
+		return result;
+	};
+
+	m_Mips.Build(image.texels, width, height, average);
+	if (m_Format == TextureFormat::RGBA8)
+		return;
+
+	switch (m_Format)
+	{
+	case TextureFormat::BC1:
+		m_Blocks.Compress(m_Mips, [](const uint32_t (&texels)[BlockCompression::TexelsPerBlock], uint64_t* pBlock) { pBlock[0] = BlockCompression::EncodeBC1(texels); });
+		break;
+	case TextureFormat::BC4:
+		m_Blocks.Compress(m_Mips, [](const uint32_t (&texels)[BlockCompression::TexelsPerBlock], uint64_t* pBlock) { pBlock[0] = BlockCompression::EncodeBC4(texels); });
+		break;
+	case TextureFormat::BC5:
+		m_Blocks.Compress(m_Mips, [](const uint32_t (&texels)[BlockCompression::TexelsPerBlock], uint64_t* pBlock)
+		{
+			pBlock[0] = BlockCompression::EncodeBC4(texels, 0);
+			pBlock[1] = BlockCompression::EncodeBC4(texels, 8);
+		});
+		break;
 	default:
-		return 0;
+		break;
 	}
+	TextureCache::StoreChain(cachePath, cacheFormat, m_Blocks);
+
+	// The RGBA8 chain was only needed as the compression source
+	m_Mips = MipChain<uint32_t>{};
+	LOG(LEVEL_INFO, "Compressed " << m_FilePath << " to " << magic_enum::enum_name(m_Format) << ", " << GetSoftwareBytes() / 1024 << " KB")
 }
 #pragma endregion
 
 #pragma region D3D
-void Texture::LoadTexture(ID3D11Device* pDevice, SDL_Surface* pSurface)
+void Texture::Upload([[maybe_unused]] ID3D11Device* pDevice)
+{
+	if (m_DecodedImage.texels.empty())
+		return;
+
+#ifndef HYBRID_HEADLESS
+	LoadTexture(pDevice, m_DecodedImage);
+#endif
+	m_DecodedImage = {};
+}
+
+#ifndef HYBRID_HEADLESS
+void Texture::LoadTexture(ID3D11Device* pDevice, const ImageIO::Image& image)
 {
 	D3D11_TEXTURE2D_DESC desc;
-	desc.Width = pSurface->w;
-	desc.Height = pSurface->h;
+	desc.Width = image.width;
+	desc.Height = image.height;
 	desc.MipLevels = 1;
 	desc.ArraySize = 1;
 	desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
@@ -117,9 +208,9 @@ void Texture::LoadTexture(ID3D11Device* pDevice, SDL_Surface* pSurface)
 	desc.MiscFlags = 0;
 
 	D3D11_SUBRESOURCE_DATA initData;
-	initData.pSysMem = pSurface->pixels;
-	initData.SysMemPitch = static_cast<UINT>(pSurface->pitch);
-	initData.SysMemSlicePitch = static_cast<UINT>(pSurface->h * pSurface->pitch);
+	initData.pSysMem = image.texels.data();
+	initData.SysMemPitch = static_cast<UINT>(image.width * sizeof(uint32_t));
+	initData.SysMemSlicePitch = static_cast<UINT>(image.height * initData.SysMemPitch);
 
 	HRESULT hr = pDevice->CreateTexture2D(&desc, &initData, &m_pTexture);
 
@@ -130,6 +221,6 @@ void Texture::LoadTexture(ID3D11Device* pDevice, SDL_Surface* pSurface)
 
 	hr = pDevice->CreateShaderResourceView(m_pTexture, &srvDesc, &m_pTextureResourceView);
 }
+#endif
 
 #pragma endregion
-
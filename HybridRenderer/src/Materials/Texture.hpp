@@ -2,39 +2,112 @@
 #define TEXTURE_HPP
 
 //General Includes
-#include <SDL.h>
 #include <string>
+#include <vector>
 
 //Project includes
+#include "Helpers/ImageIO.hpp"
 #include "Helpers/RGBColor.hpp"
+#include "Materials/BlockMipChain.hpp"
+#include "Materials/MipChain.hpp"
 
+//What the texels of a texture hold, decides the software format they are converted to at load
+enum class TextureUsage
+{
+    Color = 0,  //BC1, or RGBA8 when the texture has translucent texels
+    Normal = 1, //Tangent space normal, x and y in BC5 and z rebuilt when sampling
+    Scalar = 2  //Single channel like gloss, BC4
+};
+
+//Software texel storage
+enum class TextureFormat
+{
+    RGBA8 = 0, //4 bytes per texel
+    BC1 = 1,   //RGB, 0.5 bytes per texel
+    BC4 = 2,   //R, 0.5 bytes per texel
+    BC5 = 3    //RG, 1 byte per texel
+};
+
+//Software textures are converted once at load, RGBA8 into a MipChain of cache line tiles, the block formats into a BlockMipChain.
+//A full mip chain is built at load, minified surfaces read from the small mips instead of thrashing the cache on mip 0.
+//Block compression runs on import only, its result is cached next to the source image.
+//Loading is split so decoding can run on any thread: the constructor only records the file, Decode does the CPU work and Upload the device part.
 class Texture
 {
 public:
-    Texture(ID3D11Device* pDevice, const std::string& filePath);
+    explicit Texture(std::string filePath, TextureUsage usage = TextureUsage::Color);
     ~Texture();
     DEL_ROF(Texture)
 
+    //Workers
+    //Reads the image and builds the software texels, does not touch the device
+    void Decode();
+    //Creates the D3D texture from the decoded image and releases it, only on the thread that owns the device
+    void Upload(ID3D11Device* pDevice);
+
     /*Software*/
-    RGBColor Sample(const glm::vec2& uv) const;
-    glm::vec4 Sample4(const glm::vec2& uv) const;
-    glm::vec3 SampleV(const glm::vec2& uv) const;
-    float SampleF(const glm::vec2& uv, int component = 0) const;
+    [[nodiscard]] RGBColor Sample(const SampleFootprint& footprint) const noexcept;
+    [[nodiscard]] glm::vec4 Sample4(const SampleFootprint& footprint) const noexcept;
+    [[nodiscard]] float SampleF(const SampleFootprint& footprint, int32_t component = 0) const noexcept;
+    //Tangent space normal in [-1, 1], only meaningful for textures loaded as TextureUsage::Normal
+    [[nodiscard]] glm::vec3 SampleNormal(const SampleFootprint& footprint) const noexcept;
+    //Unfiltered texel decoded to RGBA8, red in the low byte
+    [[nodiscard]] uint32_t GetTexel(uint32_t mip, uint32_t x, uint32_t y) const noexcept;
 
     /*D3D*/
     [[nodiscard]] constexpr auto GetTextureView() const noexcept -> ID3D11ShaderResourceView* { return m_pTextureResourceView; }
+
+    //Getters
+    /*Software*/
+    [[nodiscard]] auto GetFilePath() const noexcept -> const std::string& { return m_FilePath; }
+    [[nodiscard]] constexpr auto GetUsage() const noexcept -> TextureUsage { return m_Usage; }
+    [[nodiscard]] constexpr auto GetFormat() const noexcept -> TextureFormat { return m_Format; }
+    [[nodiscard]] auto GetMipCount() const noexcept -> uint32_t { return m_Format == TextureFormat::RGBA8 ? m_Mips.GetMipCount() : m_Blocks.GetMipCount(); }
+    [[nodiscard]] auto GetWidth(const uint32_t mip = 0) const noexcept -> uint32_t { return m_Format == TextureFormat::RGBA8 ? m_Mips.GetLevel(mip).width : m_Blocks.GetLevel(mip).width; }
+    [[nodiscard]] auto GetHeight(const uint32_t mip = 0) const noexcept -> uint32_t { return m_Format == TextureFormat::RGBA8 ? m_Mips.GetLevel(mip).height : m_Blocks.GetLevel(mip).height; }
+    //Resident size of the software texels
+    [[nodiscard]] auto GetSoftwareBytes() const noexcept -> size_t { return m_Mips.GetStorage().size() * sizeof(uint32_t) + m_Blocks.GetStorage().size() * sizeof(uint64_t); }
 private:
 
+    /*General*/
+    std::string m_FilePath;
+    ImageIO::Image m_DecodedImage; // between Decode and Upload
+
     /*Software*/
-    SDL_Surface* m_pSurface;
+    TextureUsage m_Usage;
+    TextureFormat m_Format;
+    MipChain<uint32_t> m_Mips; // RGBA8, red in the low byte, only filled for TextureFormat::RGBA8
+    BlockMipChain m_Blocks;    // only filled for the block formats
+
+    void ConvertTexels(const ImageIO::Image& image);
+    [[nodiscard]] TextureFormat SelectFormat(const ImageIO::Image& image) const noexcept;
+
+    //Filtered texel, channels in [0, 1]
+    [[nodiscard]] glm::vec4 Filter(const SampleFootprint& footprint) const noexcept;
+
+    [[nodiscard]] static glm::vec4 Unpack(const uint32_t texel) noexcept
+    {
+        const auto channel = [texel](const uint32_t idx) { return static_cast<float>(texel >> (idx * 8) & 0xFF); };
+        return glm::vec4(channel(0), channel(1), channel(2), channel(3)) / 255.f;
+    }
 
-    static uint32_t GetPixel(SDL_Surface* surface, uint32_t x, uint32_t y);
+    //Single channel formats are replicated to gray so Sample and SampleF behave like on RGBA8
+    template <TextureFormat Format>
+    [[nodiscard]] static glm::vec4 DecodeBlockTexel(const uint64_t* pBlock, const uint32_t texelIdx) noexcept
+    {
+        if constexpr (Format == TextureFormat::BC1)
+            return BlockCompression::DecodeBC1(*pBlock, texelIdx);
+        else if constexpr (Format == TextureFormat::BC4)
+            return glm::vec4(glm::vec3(BlockCompression::DecodeBC4(*pBlock, texelIdx)), 1.f);
+        else
+            return glm::vec4(BlockCompression::DecodeBC5(pBlock, texelIdx), 0.f, 1.f);
+    }
 
     /*D3D*/
     ID3D11Texture2D* m_pTexture;
     ID3D11ShaderResourceView* m_pTextureResourceView;
 
-    void LoadTexture(ID3D11Device* pDevice, SDL_Surface* pSurface);
+    void LoadTexture(ID3D11Device* pDevice, const ImageIO::Image& image);
 };
 
 #endif // !TEXTURE_HPP
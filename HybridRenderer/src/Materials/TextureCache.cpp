@@ -0,0 +1,93 @@
+#include "pch.h"
+#include "Materials/TextureCache.hpp"
+
+#include <filesystem>
+#include <fstream>
+
+#include "Debugging/Logger.hpp"
+
+namespace
+{
+    constexpr uint32_t CacheMagic = 0x43545248; // "HRTC"
+    constexpr uint32_t CacheVersion = 2; // 2: interleaved maps pack a BC4 specular map
+
+    struct CacheHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t format;
+        uint32_t width;
+        uint32_t height;
+        uint32_t reserved;
+        uint64_t payloadSize;
+    };
+
+    //A cache older than any of its sources is stale
+    bool IsUpToDate(const std::filesystem::path& cachePath, const std::vector<std::string>& sourcePaths)
+    {
+        std::error_code error;
+        const auto cacheTime = std::filesystem::last_write_time(cachePath, error);
+        if (error)
+            return false;
+
+        for (const auto& sourcePath : sourcePaths)
+        {
+            const auto sourceTime = std::filesystem::last_write_time(sourcePath, error);
+            if (error || sourceTime > cacheTime)
+                return false;
+        }
+        return true;
+    }
+}
+
+std::string TextureCache::GetPath(const std::string& sourcePath, const std::string_view suffix)
+{
+    auto path = std::filesystem::path(sourcePath);
+    auto extension = std::string(".");
+    extension.append(suffix).append(".texcache");
+    path.replace_extension(extension);
+    return path.string();
+}
+
+bool TextureCache::Load(const std::string& cachePath, const Format format, const std::vector<std::string>& sourcePaths, uint32_t& width, uint32_t& height, std::vector<std::byte>& payload)
+{
+    if (!IsUpToDate(cachePath, sourcePaths))
+        return false;
+
+    std::ifstream input(cachePath, std::ios::in | std::ios::binary);
+    CacheHeader header{};
+    if (!input.read(reinterpret_cast<char*>(&header), sizeof(CacheHeader)))
+        return false;
+
+    if (header.magic != CacheMagic || header.version != CacheVersion || header.format != static_cast<uint32_t>(format))
+    {
+        LOG(LEVEL_WARNING, "Ignoring texture cache " << cachePath << ", it was written for another format")
+        return false;
+    }
+
+    payload.resize(header.payloadSize);
+    if (!input.read(reinterpret_cast<char*>(payload.data()), static_cast<std::streamsize>(header.payloadSize)))
+    {
+        LOG(LEVEL_WARNING, "Ignoring truncated texture cache " << cachePath)
+        return false;
+    }
+
+    width = header.width;
+    height = header.height;
+    return true;
+}
+
+bool TextureCache::Store(const std::string& cachePath, const Format format, const uint32_t width, const uint32_t height, const void* pPayload, const size_t payloadSize)
+{
+    std::ofstream output(cachePath, std::ios::out | std::ios::binary | std::ios::trunc);
+    const CacheHeader header{CacheMagic, CacheVersion, static_cast<uint32_t>(format), width, height, 0, payloadSize};
+    output.write(reinterpret_cast<const char*>(&header), sizeof(CacheHeader));
+    output.write(static_cast<const char*>(pPayload), static_cast<std::streamsize>(payloadSize));
+    if (!output)
+    {
+        // Not fatal, the next run converts again
+        LOG(LEVEL_WARNING, "Failed to write texture cache " << cachePath)
+        return false;
+    }
+    return true;
+}
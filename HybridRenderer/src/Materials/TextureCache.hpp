@@ -0,0 +1,56 @@
+#ifndef TEXTURE_CACHE_HPP
+#define TEXTURE_CACHE_HPP
+
+//Standard includes
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+//Software texture data converted at load is cached next to the source images, the cache is only used while it is newer than all of its sources
+namespace TextureCache
+{
+    //What a cache file holds, a cache written for another format or layout version is ignored
+    enum class Format : uint32_t
+    {
+        Interleaved = 1,
+        BC1 = 2,
+        BC4 = 3,
+        BC5 = 4
+    };
+
+    //Cache file next to the first source, "vehicle_diffuse.png" with suffix "interleaved" becomes "vehicle_diffuse.interleaved.texcache"
+    [[nodiscard]] std::string GetPath(const std::string& sourcePath, std::string_view suffix);
+
+    [[nodiscard]] bool Load(const std::string& cachePath, Format format, const std::vector<std::string>& sourcePaths, uint32_t& width, uint32_t& height, std::vector<std::byte>& payload);
+    bool Store(const std::string& cachePath, Format format, uint32_t width, uint32_t height, const void* pPayload, size_t payloadSize);
+
+    //Whole MipChain or BlockMipChain, the layout follows from the mip 0 size so only the storage is written
+    template <typename Chain>
+    [[nodiscard]] bool LoadChain(const std::string& cachePath, const Format format, const std::vector<std::string>& sourcePaths, Chain& chain)
+    {
+        uint32_t width, height;
+        std::vector<std::byte> payload;
+        if (!Load(cachePath, format, sourcePaths, width, height, payload))
+            return false;
+
+        chain.Allocate(width, height);
+        auto& storage = chain.GetStorage();
+        if (payload.size() != storage.size() * sizeof(storage[0]))
+            return false;
+        std::memcpy(storage.data(), payload.data(), payload.size());
+        return true;
+    }
+
+    template <typename Chain>
+    bool StoreChain(const std::string& cachePath, const Format format, const Chain& chain)
+    {
+        const auto& base = chain.GetLevel(0);
+        const auto& storage = chain.GetStorage();
+        return Store(cachePath, format, base.width, base.height, storage.data(), storage.size() * sizeof(storage[0]));
+    }
+}
+
+#endif // !TEXTURE_CACHE_HPP
@@ -0,0 +1,86 @@
+#include "pch.h"
+#include "Materials/TextureLoader.hpp"
+
+#include <chrono>
+
+#include "Debugging/Logger.hpp"
+#include "Helpers/magic_enum.hpp"
+#include "Helpers/JobSystem.hpp"
+#include "Materials/InterleavedTexture.hpp"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    float GetMilliseconds(const Clock::time_point start)
+    {
+        return std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+    }
+}
+
+#pragma region Workers
+Texture* TextureLoader::Queue(const std::string& filePath, const TextureUsage usage)
+{
+    auto* pTexture = new Texture(filePath, usage);
+    m_Requests.push_back({pTexture, 0.f, 0.f});
+    return pTexture;
+}
+
+InterleavedTexture* TextureLoader::QueueInterleaved(const Texture* pDiffuseMap, const Texture* pNormalMap, const Texture* pGlossMap, const Texture* pSpecularMap)
+{
+    auto* pInterleaved = new InterleavedTexture();
+    m_InterleaveRequests.push_back({pInterleaved, {pDiffuseMap, pNormalMap, pGlossMap, pSpecularMap}, 0.f});
+    return pInterleaved;
+}
+
+void TextureLoader::Load(ID3D11Device* pDevice)
+{
+    if (m_Requests.empty())
+        return;
+
+    const auto loadStart = Clock::now();
+    auto* pJobSystem = JobSystem::GetInstance();
+    LOG(LEVEL_INFO, "Decoding " << m_Requests.size() << " textures on " << std::min(pJobSystem->GetThreadCount(), static_cast<uint32_t>(m_Requests.size())) << " threads")
+
+    // Decoding is the only part that does not need the device
+    pJobSystem->ParallelFor(static_cast<uint32_t>(m_Requests.size()), [this](const uint32_t requestIdx)
+    {
+        auto& request = m_Requests[requestIdx];
+        const auto decodeStart = Clock::now();
+        request.pTexture->Decode();
+        request.decodeMs = GetMilliseconds(decodeStart);
+    });
+    const auto decodeMs = GetMilliseconds(loadStart);
+
+    // Interleaving only reads the software texels, uploading only the decoded image, so both run at once
+    JobCounter interleaveCounter{};
+    pJobSystem->ScheduleFor(static_cast<uint32_t>(m_InterleaveRequests.size()), [this](const uint32_t requestIdx)
+    {
+        auto& request = m_InterleaveRequests[requestIdx];
+        const auto interleaveStart = Clock::now();
+        request.pInterleaved->Interleave(*request.pMaps[0], *request.pMaps[1], *request.pMaps[2], *request.pMaps[3]);
+        request.interleaveMs = GetMilliseconds(interleaveStart);
+    }, interleaveCounter);
+
+    for (auto& request : m_Requests)
+    {
+        const auto uploadStart = Clock::now();
+        request.pTexture->Upload(pDevice);
+        request.uploadMs = GetMilliseconds(uploadStart);
+
+        const auto* pTexture = request.pTexture;
+        LOG(LEVEL_INFO, pTexture->GetFilePath() << ": decode " << request.decodeMs << " ms, upload " << request.uploadMs << " ms, "
+            << magic_enum::enum_name(pTexture->GetFormat()) << " " << pTexture->GetSoftwareBytes() / 1024 << " KB")
+    }
+
+    pJobSystem->Wait(interleaveCounter);
+    for (const auto& request : m_InterleaveRequests)
+    {
+        LOG(LEVEL_INFO, request.pMaps[0]->GetFilePath() << ": interleave " << request.interleaveMs << " ms")
+    }
+
+    LOG(LEVEL_INFO, "Loaded " << m_Requests.size() << " textures in " << GetMilliseconds(loadStart) << " ms, " << decodeMs << " ms of it decoding")
+    m_Requests.clear();
+    m_InterleaveRequests.clear();
+}
+#pragma endregion
@@ -0,0 +1,51 @@
+#ifndef TEXTURE_LOADER_HPP
+#define TEXTURE_LOADER_HPP
+
+//Standard includes
+#include <string>
+#include <vector>
+
+//Project includes
+#include "Materials/Texture.hpp"
+
+class InterleavedTexture;
+
+//Loads a batch of textures, images decode concurrently on the job system and only the device uploads run one after another.
+//Decoding includes the software conversion, so compressing and writing the cache run on the workers as well.
+//Queued textures are handed out right away but only hold their texels once Load returned.
+class TextureLoader final
+{
+public:
+    TextureLoader() = default;
+    ~TextureLoader() = default;
+
+    DEL_ROF(TextureLoader)
+
+    //Workers
+    //The caller owns the returned texture
+    [[nodiscard]] Texture* Queue(const std::string& filePath, TextureUsage usage = TextureUsage::Color);
+    //Packs four queued maps into one texture once they are decoded, the caller owns the returned texture
+    [[nodiscard]] InterleavedTexture* QueueInterleaved(const Texture* pDiffuseMap, const Texture* pNormalMap, const Texture* pGlossMap, const Texture* pSpecularMap);
+    //Decodes everything queued, uploads it on the calling thread while the interleaving runs on the workers and logs the time spent per texture
+    void Load(ID3D11Device* pDevice);
+
+private:
+    struct LoadRequest
+    {
+        Texture* pTexture;
+        float decodeMs;
+        float uploadMs;
+    };
+
+    struct InterleaveRequest
+    {
+        InterleavedTexture* pInterleaved;
+        const Texture* pMaps[4]; // diffuse, normal, gloss, specular
+        float interleaveMs;
+    };
+
+    std::vector<LoadRequest> m_Requests;
+    std::vector<InterleaveRequest> m_InterleaveRequests;
+};
+
+#endif // !TEXTURE_LOADER_HPP
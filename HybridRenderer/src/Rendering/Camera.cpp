@@ -2,7 +2,12 @@
 #include "Rendering/Camera.hpp"
 
 #include "Geometry/Mesh.hpp"
+#include "Helpers/GeometryHelpers.hpp"
+#include "Helpers/SIMDHelpers.hpp"
+#include "Helpers/JobSystem.hpp"
+#ifndef HYBRID_HEADLESS
 #include <SDL.h>
+#endif
 #include <glm/gtc/matrix_access.hpp>
 #include <glm/gtx/euler_angles.hpp>
 
@@ -56,14 +61,16 @@ void Camera::Update(const float dT)
 
 void Camera::UpdateLookAtMatrix(float dT)
 {
+    glm::vec3 movement{};
+    glm::vec3 worldMovement{};
+
+    // Headless builds have no input, the camera only moves through its setters
+#ifndef HYBRID_HEADLESS
     glm::ivec2 dMove;
 
     const auto buttonMask = SDL_GetRelativeMouseState(&dMove.x, &dMove.y);
     const auto* keyState = SDL_GetKeyboardState(nullptr);
 
-    glm::vec3 movement{};
-    glm::vec3 worldMovement{};
-
     // Don't update the movement if we're hovering over any ImGui UI (this is not an ideal place to do this, but it works
     if (!ImGui::GetIO().WantCaptureMouse)
     {
@@ -135,6 +142,9 @@ void Camera::UpdateLookAtMatrix(float dT)
             //movement.x += m_MovementSensitivity;
         }
     }
+#else
+    static_cast<void>(dT);
+#endif
     //Apply local space movement (m_LookAt needs to be transposed for D3D because...reasons??? - 
     //seemingly because vector transformation need the transposed inverse of the world matrix)
     //Some movement is still broken when y < 0
@@ -227,48 +237,111 @@ void Camera::UpdateLookAtMatrix(float dT)
 
 /*Software*/
 
-void Camera::MakeScreenSpace(Mesh* pMesh) const
+void Camera::MakeScreenSpace(Mesh* pMesh, FrameArena& frameArena) const
 {
-    std::vector<VertexOutput> sSVertices;
+    // Big enough to be worth a job, small enough to spread heavy meshes over every thread
+    constexpr uint32_t chunkSize = 128 * VertexBatchSize;
+
+    const auto& input = pMesh->GetVertexStreams();
+    auto& output = pMesh->GetScreenSpaceVertices();
+    output.Allocate(frameArena, input.count);
 
     const auto meshWorld = pMesh->GetWorld();
-    const auto meshWorld3 = glm::mat3(meshWorld);
     const auto viewProjWorldMatrix = m_ProjectionMatrix * m_CameraMatrix * meshWorld;
-    
-    for (const auto& v : pMesh->GetVertices())
+
+    const auto paddedCount = static_cast<uint32_t>(input.posX.size());
+    JobSystem::GetInstance()->ParallelFor((paddedCount + chunkSize - 1) / chunkSize, [&, this](const uint32_t chunkIdx)
     {
-        VertexOutput sSV{};
-        sSV.uv = v.uv;
-        sSV.worldPos = meshWorld * glm::vec4(v.pos, 1.f);
-
-        sSV.pos = viewProjWorldMatrix * glm::vec4(v.pos, 1.f);
-        sSV.normal = v.normal * meshWorld3;
-        sSV.tangent = v.tangent * meshWorld3;
-
-        // Perspective transform
-        sSV.pos.x /= sSV.pos.w;
-        sSV.pos.y /= sSV.pos.w;
-        sSV.pos.z /= sSV.pos.w;
-
-        sSV.viewDirection = glm::normalize(meshWorld * glm::vec4(v.pos, 1.f) - glm::vec4(m_Origin.x, m_Origin.y, -m_Origin.z, 1.f));
-        if (sSV.pos.x < -1 || sSV.pos.x > 1
-            || sSV.pos.y < -1 || sSV.pos.y > 1
-            || sSV.pos.z < 0 || sSV.pos.z > 1)
+        const auto last = std::min(paddedCount, (chunkIdx + 1) * chunkSize);
+        for (auto first = chunkIdx * chunkSize; first < last; first += VertexBatchSize)
         {
-            sSV.culled = true;
+            TransformBatch(input, output, first, viewProjWorldMatrix, meshWorld);
         }
-        else
+    });
+}
+
+void Camera::TransformBatch(const VertexInputStreams& input, VertexOutputStreams& output, const uint32_t first,
+                            const glm::mat4& viewProjWorldMatrix, const glm::mat4& meshWorld) const noexcept
+{
+    using bsimd::Float8;
+
+    // Column major, m[column][row]
+    const auto transform = [](const glm::mat4& m, const uint32_t row, const Float8& x, const Float8& y, const Float8& z)
+    {
+        return MulAdd(Float8::Broadcast(m[0][row]), x, MulAdd(Float8::Broadcast(m[1][row]), y, MulAdd(Float8::Broadcast(m[2][row]), z, Float8::Broadcast(m[3][row]))));
+    };
+    // Normals and tangents are multiplied from the left (v * M)
+    const auto transformDirection = [](const glm::mat4& m, const uint32_t column, const Float8& x, const Float8& y, const Float8& z)
+    {
+        return MulAdd(x, Float8::Broadcast(m[column][0]), MulAdd(y, Float8::Broadcast(m[column][1]), z * Float8::Broadcast(m[column][2])));
+    };
+
+    const auto posX = Float8::Load(&input.posX[first]);
+    const auto posY = Float8::Load(&input.posY[first]);
+    const auto posZ = Float8::Load(&input.posZ[first]);
+
+    const auto clipX = transform(viewProjWorldMatrix, 0, posX, posY, posZ);
+    const auto clipY = transform(viewProjWorldMatrix, 1, posX, posY, posZ);
+    const auto clipZ = transform(viewProjWorldMatrix, 2, posX, posY, posZ);
+    const auto clipW = transform(viewProjWorldMatrix, 3, posX, posY, posZ);
+
+    const auto worldX = transform(meshWorld, 0, posX, posY, posZ);
+    const auto worldY = transform(meshWorld, 1, posX, posY, posZ);
+    const auto worldZ = transform(meshWorld, 2, posX, posY, posZ);
+    worldX.Store(&output.worldX[first]);
+    worldY.Store(&output.worldY[first]);
+    worldZ.Store(&output.worldZ[first]);
+
+    const auto normalX = Float8::Load(&input.normalX[first]);
+    const auto normalY = Float8::Load(&input.normalY[first]);
+    const auto normalZ = Float8::Load(&input.normalZ[first]);
+    transformDirection(meshWorld, 0, normalX, normalY, normalZ).Store(&output.normalX[first]);
+    transformDirection(meshWorld, 1, normalX, normalY, normalZ).Store(&output.normalY[first]);
+    transformDirection(meshWorld, 2, normalX, normalY, normalZ).Store(&output.normalZ[first]);
+
+    const auto tangentX = Float8::Load(&input.tangentX[first]);
+    const auto tangentY = Float8::Load(&input.tangentY[first]);
+    const auto tangentZ = Float8::Load(&input.tangentZ[first]);
+    transformDirection(meshWorld, 0, tangentX, tangentY, tangentZ).Store(&output.tangentX[first]);
+    transformDirection(meshWorld, 1, tangentX, tangentY, tangentZ).Store(&output.tangentY[first]);
+    transformDirection(meshWorld, 2, tangentX, tangentY, tangentZ).Store(&output.tangentZ[first]);
+
+    std::copy_n(&input.u[first], VertexBatchSize, &output.u[first]);
+    std::copy_n(&input.v[first], VertexBatchSize, &output.v[first]);
+
+    const auto viewX = worldX - Float8::Broadcast(m_Origin.x);
+    const auto viewY = worldY - Float8::Broadcast(m_Origin.y);
+    const auto viewZ = worldZ + Float8::Broadcast(m_Origin.z);
+    const auto invLength = Float8::Broadcast(1.f) / Sqrt(MulAdd(viewX, viewX, MulAdd(viewY, viewY, viewZ * viewZ)));
+    (viewX * invLength).Store(&output.viewX[first]);
+    (viewY * invLength).Store(&output.viewY[first]);
+    (viewZ * invLength).Store(&output.viewZ[first]);
+
+    // Perspective transform and convert to screenspace, lanes that need clipping are put back in clip space below
+    const auto invW = Float8::Broadcast(1.f) / clipW;
+    const auto half = Float8::Broadcast(0.5f);
+    (MulAdd(clipX * invW, half, half) * Float8::Broadcast(static_cast<float>(m_Width))).Store(&output.posX[first]);
+    ((half - clipY * invW * half) * Float8::Broadcast(static_cast<float>(m_Height))).Store(&output.posY[first]);
+    (clipZ * invW).Store(&output.posZ[first]);
+    clipW.Store(&output.posW[first]);
+
+    float clipPos[4][VertexBatchSize];
+    clipX.Store(clipPos[0]);
+    clipY.Store(clipPos[1]);
+    clipZ.Store(clipPos[2]);
+    clipW.Store(clipPos[3]);
+    for (uint32_t lane = 0; lane < VertexBatchSize; ++lane)
+    {
+        const glm::vec4 pos(clipPos[0][lane], clipPos[1][lane], clipPos[2][lane], clipPos[3][lane]);
+        const auto idx = first + lane;
+        output.clipCodes[idx] = bgh::CalculateClipCodes(pos);
+        if ((output.clipCodes[idx] & bgh::ClipRequired) != 0)
         {
-            sSV.culled = false;
+            output.posX[idx] = pos.x;
+            output.posY[idx] = pos.y;
+            output.posZ[idx] = pos.z;
         }
-
-    
-        // Convert to screenspace    
-        sSV.pos.x = (sSV.pos.x + 1) / 2 * m_Width;
-        sSV.pos.y = (1 - sSV.pos.y) / 2 * m_Height;
-        sSVertices.push_back(sSV);
     }
-    pMesh->SetScreenSpaceVertices(sSVertices);
 }
 #pragma endregion
 
@@ -285,6 +358,13 @@ void Camera::SetFOV(const float fovD)
     m_FOV = glm::tan(glm::radians(fovD) / 2.f);
 }
 
+void Camera::SetPose(const glm::vec3& origin, const float pitch, const float yaw) noexcept
+{
+    m_Origin = origin;
+    m_Pitch = pitch;
+    m_Yaw = yaw;
+}
+
 void Camera::ToggleRenderSystem(const RenderSystem& renderSystem)
 {
     m_RenderSystem = renderSystem;
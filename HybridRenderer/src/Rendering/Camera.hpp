@@ -4,7 +4,10 @@
 //Project includes
 #include "Scene/SceneGraph.hpp"
 
+class FrameArena;
 class Mesh;
+struct VertexInputStreams;
+struct VertexOutputStreams;
 
 class Camera
 {
@@ -16,10 +19,13 @@ public:
 
     //Workers
     void Update(float dT);
-    void MakeScreenSpace(Mesh* pMesh) const;
+    //Transforms the mesh's vertices into screen space streams allocated from the frame arena, 8 vertices per batch and split into chunks over the job system
+    void MakeScreenSpace(Mesh* pMesh, FrameArena& frameArena) const;
     //Setters
     void SetResolution(uint32_t width, uint32_t height);
     void SetFOV(float fovD);
+    //Places the camera directly, the matrices follow on the next Update. Used for scripted paths
+    void SetPose(const glm::vec3& origin, float pitch, float yaw) noexcept;
     void ToggleRenderSystem(const RenderSystem& renderSystem);
 
     //Getters
@@ -62,5 +68,7 @@ private:
     glm::vec3 m_Up;
 
     void UpdateLookAtMatrix(float dT);
+    void TransformBatch(const VertexInputStreams& input, VertexOutputStreams& output, uint32_t first,
+                        const glm::mat4& viewProjWorldMatrix, const glm::mat4& meshWorld) const noexcept;
 };
 #endif // !CAMERA_HPP
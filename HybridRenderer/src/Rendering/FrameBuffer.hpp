@@ -0,0 +1,114 @@
+#ifndef FRAME_BUFFER_HPP
+#define FRAME_BUFFER_HPP
+
+//Standard includes
+#include <algorithm>
+#include <cstdint>
+
+//Project includes
+#include "Helpers/GeometryHelpers.hpp"
+#include "Helpers/SIMDHelpers.hpp"
+
+//Size of a hierarchical Z block in pixels, tiles are always a multiple of this so a block is owned by a single tile
+constexpr uint32_t HiZBlockSize = 8;
+
+//What a rasterization pass does with the fragments it produces
+enum class RasterPass
+{
+    Shade = 0,      //Depth test, write depth and shade
+    DepthOnly = 1,  //Depth test and write depth, nothing is shaded
+    ShadeEqual = 2, //Shade the fragments that match the depth a DepthOnly pass left behind
+    Blend = 3       //Depth test without writing, blended fragments are accumulated for the order independent resolve
+};
+
+//Non-owning view on the buffers the software rasterizer writes to for a single frame
+struct FrameBuffer
+{
+    uint32_t* pPixels = nullptr;
+    bsimd::PackedFormat format{}; // channel layout of pPixels
+    float* pDepth = nullptr;
+    uint32_t width = 0;
+    uint32_t height = 0;
+
+    //Farthest depth per HiZBlockSize x HiZBlockSize block of pDepth
+    float* pHiZ = nullptr;
+    uint32_t hiZWidth = 0;
+
+    //Triangle id per pixel (0 is empty), when set the rasterizer only writes ids and shading is deferred to the resolve pass
+    uint32_t* pVisibility = nullptr;
+
+    //Multisampling, with more than one sample pDepth and pVisibility hold a value per sample and colors go to pSampleColors until they're resolved to pPixels.
+    //Samples are stored per span: every group of SpanWidth pixels in a row holds one plane of SpanWidth values per sample, so a span test runs once per plane.
+    uint32_t sampleCount = 1;
+    uint32_t sampleStride = 0; // pixels per row in the sample buffers, width rounded up to a whole span
+    uint32_t* pSampleColors = nullptr;
+
+    //Weighted blended order independent transparency, premultiplied color times weight (alpha holds the weighted opacity) and the product of 1 - opacity per pixel
+    glm::vec4* pAccumulation = nullptr;
+    float* pRevealage = nullptr;
+
+    RasterPass pass = RasterPass::Shade;
+
+    [[nodiscard]] auto GetHiZ(const uint32_t blockX, const uint32_t blockY) const noexcept -> float { return pHiZ[blockX + blockY * hiZWidth]; }
+
+    //Index of a pixel's first sample, sample s of the pixel sits s * SpanWidth further
+    [[nodiscard]] auto GetSampleIdx(const uint32_t x, const uint32_t y) const noexcept -> uint32_t
+    {
+        return (y * sampleStride + (x & ~(bsimd::SpanWidth - 1))) * sampleCount + (x & (bsimd::SpanWidth - 1));
+    }
+
+    //Adds a blended fragment, the weight falls off with view depth so closer surfaces dominate without sorting (McGuire and Bavoil)
+    void Accumulate(const uint32_t pixelIdx, const glm::vec4& color, const float viewDepth) const noexcept
+    {
+        const auto near = viewDepth / 5.f;
+        const auto far = viewDepth / 200.f;
+        const auto weight = color.a * std::clamp(10.f / (1e-5f + near * near + far * far * far * far * far * far), 1e-2f, 3e3f);
+        pAccumulation[pixelIdx] += glm::vec4(glm::vec3(color) * weight, weight);
+        pRevealage[pixelIdx] *= 1.f - color.a;
+    }
+
+    //Recalculates the farthest depth of a block after the rasterizer wrote to it
+    void RefreshHiZ(const uint32_t blockX, const uint32_t blockY) const noexcept
+    {
+        const auto minX = blockX * HiZBlockSize;
+        const auto minY = blockY * HiZBlockSize;
+        const auto maxX = std::min(minX + HiZBlockSize, width);
+        const auto maxY = std::min(minY + HiZBlockSize, height);
+
+        auto farthest = 0.f;
+        for (auto y = minY; y < maxY; ++y)
+        {
+            if (sampleCount > 1)
+            {
+                // A block row is exactly one span, so its samples are the planes of a single group
+                const auto* pSamples = pDepth + GetSampleIdx(minX, y);
+                for (uint32_t sample = 0; sample < sampleCount; ++sample)
+                {
+                    for (auto lane = 0u; lane < maxX - minX; ++lane)
+                    {
+                        farthest = std::max(farthest, pSamples[sample * bsimd::SpanWidth + lane]);
+                    }
+                }
+                continue;
+            }
+
+            const auto* pRow = pDepth + y * width;
+            for (auto x = minX; x < maxX; ++x)
+            {
+                farthest = std::max(farthest, pRow[x]);
+            }
+        }
+        pHiZ[blockX + blockY * hiZWidth] = farthest;
+    }
+};
+
+//Screen rectangle in pixels, min inclusive, max exclusive
+struct TileRect
+{
+    uint32_t minX = 0;
+    uint32_t minY = 0;
+    uint32_t maxX = 0;
+    uint32_t maxY = 0;
+};
+
+#endif // !FRAME_BUFFER_HPP
@@ -0,0 +1,49 @@
+#include "pch.h"
+#include "Rendering/HeadlessRenderer.hpp"
+
+#include "Helpers/JobSystem.hpp"
+#include "Rendering/SoftwareRasterizer.hpp"
+#include "Scene/SceneGraph.hpp"
+#include "Scene/SceneLoader.hpp"
+
+HeadlessRenderer::HeadlessRenderer(const uint32_t width, const uint32_t height, const std::string_view sceneName)
+    : m_pSceneGraph(SceneGraph::GetInstance()),
+      m_Frame{width, height, std::vector<uint32_t>(width * height)},
+      m_pSoftwareRasterizer(nullptr),
+      m_IsSceneLoaded(false)
+{
+    m_pSceneGraph->SetCamera(glm::vec3(0, 5, 65), width, height, 60.f);
+
+    JobSystem::GetInstance()->Configure(m_pSceneGraph->GetThreadCount());
+    m_pSoftwareRasterizer = new SoftwareRasterizer(width, height, m_pSceneGraph->GetSoftwareTileSize());
+
+    // There is no device, textures only get their software texels and meshes skip their D3D buffers
+    m_IsSceneLoaded = SceneLoader::Load(sceneName, nullptr);
+}
+
+HeadlessRenderer::~HeadlessRenderer()
+{
+    SafeDelete(m_pSoftwareRasterizer);
+}
+
+#pragma region Workers
+void HeadlessRenderer::Render()
+{
+    if (m_pSceneGraph->ShouldUpdateSoftwarePipeline())
+    {
+        JobSystem::GetInstance()->Wait(m_pSceneGraph->GetUpdateCounter());
+        JobSystem::GetInstance()->Configure(m_pSceneGraph->GetThreadCount());
+        m_pSoftwareRasterizer->Configure(m_pSceneGraph->GetSoftwareTileSize());
+        m_pSceneGraph->ConfirmSoftwarePipelineUpdate();
+    }
+
+    // The image is RGBA8 with red in the low byte, alpha is always opaque
+    const bsimd::PackedFormat packedFormat{0, 8, 16, 0xFF000000};
+    m_pSoftwareRasterizer->Render(m_Frame.texels.data(), packedFormat);
+}
+
+bool HeadlessRenderer::SaveFrame(const std::string& filePath) const
+{
+    return ImageIO::SavePNG(filePath, m_Frame);
+}
+#pragma endregion
@@ -0,0 +1,40 @@
+#ifndef HEADLESS_RENDERER_HPP
+#define HEADLESS_RENDERER_HPP
+
+//Standard includes
+#include <string>
+#include <string_view>
+
+//Project includes
+#include "Helpers/ImageIO.hpp"
+
+class SceneGraph;
+class SoftwareRasterizer;
+
+//Software only renderer without a window, frames are rasterized into an offscreen image that can be written to disk.
+//Starts from the same camera as the windowed renderer, frames are not pipelined so the image always holds the last rendered frame.
+class HeadlessRenderer final
+{
+public:
+    //Loads the named scene, see SceneLoader for the names
+    HeadlessRenderer(uint32_t width, uint32_t height, std::string_view sceneName);
+    ~HeadlessRenderer();
+
+    DEL_ROF(HeadlessRenderer)
+
+    //Workers
+    void Render();
+    bool SaveFrame(const std::string& filePath) const;
+
+    //Getters
+    [[nodiscard]] auto GetFrame() const noexcept -> const ImageIO::Image& { return m_Frame; }
+    [[nodiscard]] constexpr auto IsSceneLoaded() const noexcept -> bool { return m_IsSceneLoaded; }
+
+private:
+    SceneGraph* m_pSceneGraph;
+    ImageIO::Image m_Frame;
+    SoftwareRasterizer* m_pSoftwareRasterizer;
+    bool m_IsSceneLoaded;
+};
+
+#endif // !HEADLESS_RENDERER_HPP
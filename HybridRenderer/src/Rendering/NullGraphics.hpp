@@ -0,0 +1,19 @@
+#ifndef NULL_GRAPHICS_HPP
+#define NULL_GRAPHICS_HPP
+
+//Null graphics backend of the headless build.
+//The device types are declared but never defined, so every handle stays null and whatever would talk to a device is compiled out.
+//Mesh, Material and Texture keep their interfaces, their software paths are the same code in both builds.
+struct ID3D11Device;
+struct ID3D11DeviceContext;
+struct ID3D11Buffer;
+struct ID3D11InputLayout;
+struct ID3D11Texture2D;
+struct ID3D11ShaderResourceView;
+struct ID3DX11Effect;
+struct ID3DX11EffectTechnique;
+struct ID3DX11EffectMatrixVariable;
+struct ID3DX11EffectScalarVariable;
+struct ID3DX11EffectShaderResourceVariable;
+
+#endif // !NULL_GRAPHICS_HPP
@@ -10,10 +10,13 @@
 #pragma warning (pop)
 
 #include "Debugging/Logger.hpp"
+#include "Geometry/Mesh.hpp"
+#include "Helpers/AllocationCounter.hpp"
+#include "Helpers/JobSystem.hpp"
 #include "Materials/MaterialManager.hpp"
-#include "Materials/MaterialMapped.hpp"
-#include "Materials/MaterialFlat.hpp"
 #include "Rendering/Camera.hpp"
+#include "Rendering/SoftwareRasterizer.hpp"
+#include "Scene/SceneLoader.hpp"
 
 Renderer::Renderer(SDL_Window* pWindow)
 	: m_pWindow(pWindow)
@@ -40,11 +43,7 @@ Renderer::Renderer(SDL_Window* pWindow)
 	SetImGuiRenderSystem(true);
 
 	//Objects and materials are initialized here as m_pDevice is needed for object initialization
-	MaterialManager::GetInstance()->AddMaterial(new MaterialMapped(m_pDevice, L"./Resources/Shaders/PosCol3D.fx", "./Resources/Textures/vehicle_diffuse.png", "./Resources/Textures/vehicle_normal.png", "./Resources/Textures/vehicle_gloss.png", "./Resources/Textures/vehicle_specular.png", 25.f, "ShipMat", false));
-	MaterialManager::GetInstance()->AddMaterial(new MaterialFlat(m_pDevice, L"./Resources/Shaders/FlatTransparency.fx", "./Resources/Textures/fireFX_diffuse.png", "FireMat", true));
-	m_pSceneGraph->AddScene(0);
-	m_pSceneGraph->AddObjectToGraph(new Mesh(m_pDevice, "./Resources/Meshes/vehicle.obj", MaterialManager::GetInstance()->GetMaterial("ShipMat"), glm::vec3(0, 0, 0)), 0);
-	m_pSceneGraph->AddObjectToGraph(new Mesh(m_pDevice, "./Resources/Meshes/fireFX.obj", MaterialManager::GetInstance()->GetMaterial("FireMat"), glm::vec3(0, 0, 0)), 0);
+	SceneLoader::Load(SceneLoader::SceneNames[0], m_pDevice);
 }
 
 Renderer::~Renderer()
@@ -57,11 +56,16 @@ Renderer::~Renderer()
 	DirectXCleanup();
 
 	// Software Cleanup
-	SafeDelete(m_pDepthBuffer);
+	for (auto* pSoftwareBuffer : m_pSoftwareBuffers)
+	{
+		SDL_FreeSurface(pSoftwareBuffer);
+	}
+	delete[] m_pRTRenderColors;
+	SafeDelete(m_pSoftwareRasterizer);
 	SDL_GL_DeleteContext(SDL_GL_GetCurrentContext());
 }
 
-void Renderer::Render() const 
+void Renderer::Render()
 {
 
 	if (m_pSceneGraph->ShouldUpdateRenderSystem())
@@ -73,41 +77,41 @@ void Renderer::Render() const
 
 	if (m_pSceneGraph->ShouldUpdateHardwareTypes())
 	{
-		for (const auto [id, pMat] : MaterialManager::GetInstance()->GetMaterials())
+		for (const auto& slot : MaterialManager::GetInstance()->GetMaterials())
 		{
-			pMat->UpdateTypeSettings(m_pSceneGraph->GetHardwareRenderType(), m_pSceneGraph->GetHardwareFilterType());
+			if (slot.pMaterial != nullptr)
+				slot.pMaterial->UpdateTypeSettings(m_pSceneGraph->GetHardwareRenderType(), m_pSceneGraph->GetHardwareFilterType());
 		}
 		m_pSceneGraph->ConfirmHardwareTypesUpdate();
 	}
 	
+	if (m_pSceneGraph->ShouldUpdateSoftwarePipeline())
+	{
+		// The workers can only restart once the scene update queued this frame ran
+		JobSystem::GetInstance()->Wait(m_pSceneGraph->GetUpdateCounter());
+		JobSystem::GetInstance()->Configure(m_pSceneGraph->GetThreadCount());
+		m_pSoftwareRasterizer->Configure(m_pSceneGraph->GetSoftwareTileSize());
+		m_pSceneGraph->ConfirmSoftwarePipelineUpdate();
+	}
+	
 	switch (m_pSceneGraph->GetRenderSystem())
 	{
 	case Software:
 		{
-			// This is the surface we'll be rendering to, we need to lock it to write to it
-			SDL_LockSurface(m_pSoftwareBuffer);
-			
-			// Clear OpenGL and software buffers
-			const auto clearColor = RGBColor(128.f, 128.f, 128.f);
-			glClearColor(clearColor.r / 255.f, clearColor.g / 255.f, clearColor.b / 255.f, 1.0f);
-			glClear(GL_COLOR_BUFFER_BIT);
-
-			std::fill_n(m_pDepthBuffer, m_Width * m_Height, std::numeric_limits<float>::infinity());
-			std::fill_n(static_cast<uint32_t*>(m_pSoftwareBufferPixels), m_Width * m_Height,
-				SDL_MapRGB(m_pSoftwareBuffer->format,
-                static_cast<uint8_t>(clearColor.r),
-                static_cast<uint8_t>(clearColor.g),
-                static_cast<uint8_t>(clearColor.b)));
-
-			// Prepare new ImGui frame
+			// Frame N + 1 rasterizes on the workers while frame N is uploaded and swapped, so the screen runs one frame behind.
+			// The debug UI goes first, nothing is rasterizing while it changes settings and they apply to the frame queued right after.
 			ImGui_ImplOpenGL2_NewFrame();
 			ImGui_ImplSDL2_NewFrame(m_pWindow);
 			ImGui::NewFrame();
-			
-			// Render
+			Logger::GetInstance()->OutputLog();
+			SceneGraph::GetInstance()->RenderDebugUI();
+
+			// This is the surface we'll be rendering to, we need to lock it to write to it
+			auto* pBackBuffer = m_pSoftwareBuffers[m_BackBufferIdx];
+			SDL_LockSurface(pBackBuffer);
 			if (m_pSceneGraph->ShouldShowRTRender())
 			{
-				memcpy(m_pSoftwareBufferPixels, m_pRTRenderPixels, m_Width * m_Height);
+				PresentRTRender(pBackBuffer);
 
 				if (m_pSceneGraph->ShouldRenderRTFrame())
 				{
@@ -117,29 +121,31 @@ void Renderer::Render() const
 			}
 			else
 			{
-				for (auto pObject : m_pSceneGraph->GetCurrentSceneObjects())
-				{
-					m_pSceneGraph->GetCamera()->MakeScreenSpace(pObject);
-					pObject->Rasterize(m_pSoftwareBuffer, m_pSoftwareBufferPixels, m_pDepthBuffer, m_Width, m_Height);
-				}
+				JobSystem::GetInstance()->Schedule([this]() { RasterizeSoftwareFrame(); }, m_FrameCounter);
 			}
 
+			{
+				// Whatever presenting allocates is none of the frame's business
+				const AllocationCounter::IgnoreScope ignoreAllocations{};
 
-			// We're done writing to the surface, so we can unlock it
-			SDL_UnlockSurface(m_pSoftwareBuffer);
+				// Render the previous software frame as background image to allow ImGui overlay
+				const auto clearColor = RGBColor(128.f, 128.f, 128.f);
+				glClearColor(clearColor.r / 255.f, clearColor.g / 255.f, clearColor.b / 255.f, 1.0f);
+				glClear(GL_COLOR_BUFFER_BIT);
+				ImplementSoftwareWithOpenGL(m_pSoftwareBuffers[1 - m_BackBufferIdx]);
 
-			// Render software render as background image to allow ImGui overlay
-			ImplementSoftwareWithOpenGL();
+				// Present ImGui data before final OpenGL render
+				ImGui::Render();
+				ImGui_ImplOpenGL2_RenderDrawData(ImGui::GetDrawData());
 
-			Logger::GetInstance()->OutputLog();
-			SceneGraph::GetInstance()->RenderDebugUI();
-			
-			// Present ImGui data before final OpenGL render
-			ImGui::Render();
-			ImGui_ImplOpenGL2_RenderDrawData(ImGui::GetDrawData());
+				// Swap the OpenGL buffers for final output
+				SDL_GL_SwapWindow(m_pWindow);
+			}
 
-			// Swap the OpenGL buffers for final output
-			SDL_GL_SwapWindow(m_pWindow);
+			// We're done writing to the surface, so we can unlock it and present it next frame
+			JobSystem::GetInstance()->Wait(m_FrameCounter);
+			SDL_UnlockSurface(pBackBuffer);
+			m_BackBufferIdx = 1 - m_BackBufferIdx;
 			break;
 		}
 	case D3D:
@@ -159,6 +165,7 @@ void Renderer::Render() const
 			ImGui::NewFrame();
 		
 			//Render
+			JobSystem::GetInstance()->Wait(m_pSceneGraph->GetUpdateCounter());
 			for (auto& mesh : m_pSceneGraph->GetCurrentSceneObjects())
 			{
 				mesh->Render(m_pDeviceContext, m_pSceneGraph->GetCamera());
@@ -220,14 +227,42 @@ void Renderer::SetupSoftwarePipeline() noexcept
 	SDL_GL_SetSwapInterval(1); // Enable vsync
 
 	// Setup pixel and depth buffers
-	m_pSoftwareBuffer = SDL_CreateRGBSurface(0, m_Width, m_Height, 32, 0, 0, 0, 0);
-	m_pSoftwareBufferPixels = static_cast<uint32_t*>(m_pSoftwareBuffer->pixels);
-	m_pRTRender = SDL_CreateRGBSurface(0, m_Width, m_Height, 32, 0, 0, 0, 0);
-	m_pRTRenderPixels = static_cast<uint32_t*>(m_pSoftwareBuffer->pixels);
-	m_pDepthBuffer = new float[m_Width * m_Height];
+	// Two back buffers, one is rasterized into while the other one is presented
+	for (auto& pSoftwareBuffer : m_pSoftwareBuffers)
+	{
+		pSoftwareBuffer = SDL_CreateRGBSurface(0, m_Width, m_Height, 32, 0, 0, 0, 0);
+		SDL_FillRect(pSoftwareBuffer, nullptr, SDL_MapRGB(pSoftwareBuffer->format, 128, 128, 128));
+	}
+	m_pRTRenderColors = new glm::vec3[m_Width * m_Height];
+	std::fill_n(m_pRTRenderColors, m_Width * m_Height, RGBColor(128.f, 128.f, 128.f) / 255.f);
+
+	// Setup the workers, then the depth, tile and blending buffers the back buffers share
+	JobSystem::GetInstance()->Configure(m_pSceneGraph->GetThreadCount());
+	m_pSoftwareRasterizer = new SoftwareRasterizer(m_Width, m_Height, m_pSceneGraph->GetSoftwareTileSize());
+}
+
+void Renderer::RasterizeSoftwareFrame() const
+{
+	// The back buffer's pixel format is resolved once here, every pass after this packs its colors with it
+	auto* pBackBuffer = m_pSoftwareBuffers[m_BackBufferIdx];
+	const auto* pPixelFormat = pBackBuffer->format;
+	const bsimd::PackedFormat packedFormat{pPixelFormat->Rshift, pPixelFormat->Gshift, pPixelFormat->Bshift, pPixelFormat->Amask};
+	m_pSoftwareRasterizer->Render(static_cast<uint32_t*>(pBackBuffer->pixels), packedFormat);
+}
+
+void Renderer::PresentRTRender(SDL_Surface* pBackBuffer) const noexcept
+{
+	// Same packer as the rasterizer's output, a row at a time since the surface rows can be padded
+	const auto* pPixelFormat = pBackBuffer->format;
+	const bsimd::PackedFormat packedFormat{pPixelFormat->Rshift, pPixelFormat->Gshift, pPixelFormat->Bshift, pPixelFormat->Amask};
+	auto* pRow = static_cast<uint8_t*>(pBackBuffer->pixels);
+	for (uint32_t y = 0; y < m_Height; ++y, pRow += pBackBuffer->pitch)
+	{
+		bsimd::PackColors(m_pRTRenderColors + y * m_Width, m_Width, packedFormat, reinterpret_cast<uint32_t*>(pRow));
+	}
 }
 
-void Renderer::ImplementSoftwareWithOpenGL() const noexcept
+void Renderer::ImplementSoftwareWithOpenGL(const SDL_Surface* pSoftwareBuffer) const noexcept
 {
 	// Generate and bind a texture resource from OpenGL
 	GLuint texture;
@@ -235,8 +270,8 @@ void Renderer::ImplementSoftwareWithOpenGL() const noexcept
 	glBindTexture(GL_TEXTURE_2D, texture);
 
 	// Make a Texture2D from the software buffer we rendered
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, m_pSoftwareBuffer->w, m_pSoftwareBuffer->h, 0,
-		GL_BGRA,GL_UNSIGNED_BYTE, m_pSoftwareBufferPixels );
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, pSoftwareBuffer->w, pSoftwareBuffer->h, 0,
+		GL_BGRA,GL_UNSIGNED_BYTE, pSoftwareBuffer->pixels );
 
 	// Mipmap filtering. Has to be set for texture to render
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
@@ -2,8 +2,10 @@
 #define	RENDERER_HPP
 
 // Project includes
+#include "Helpers/JobSystem.hpp"
 #include "Scene/SceneGraph.hpp"
 
+class SoftwareRasterizer;
 class Timer;
 struct SDL_Window;
 struct SDL_Surface;
@@ -16,7 +18,8 @@ public:
 
     DEL_ROF(Renderer)
 
-    void Render() const;
+    //Software frames are pipelined, the frame rasterizes on the workers while the previous one is presented
+    void Render();
     void SetImGuiRenderSystem(bool isInitialSetup = false) const;
 private:
     /*General*/
@@ -29,15 +32,19 @@ private:
     SceneGraph* m_pSceneGraph;
 
     /*Software*/
-    SDL_Surface* m_pSoftwareBuffer = nullptr;
-    SDL_Surface* m_pRTRender = nullptr;
-    uint32_t* m_pSoftwareBufferPixels = nullptr;
-    uint32_t* m_pRTRenderPixels = nullptr;
-    float* m_pDepthBuffer = nullptr;
+    SDL_Surface* m_pSoftwareBuffers[2]{}; // back buffers, one is rasterized into while the other one is presented
+    uint32_t m_BackBufferIdx = 0;
+    JobCounter m_FrameCounter;
+    glm::vec3* m_pRTRenderColors = nullptr; // linear [0, 1] colors of the RT render, packed into the back buffer's format when shown
+    SoftwareRasterizer* m_pSoftwareRasterizer = nullptr;
 
     //Setup
     void SetupSoftwarePipeline() noexcept;
-    void ImplementSoftwareWithOpenGL() const noexcept;
+    void ImplementSoftwareWithOpenGL(const SDL_Surface* pSoftwareBuffer) const noexcept;
+    //Packs the RT render into the given back buffer, which has to be locked
+    void PresentRTRender(SDL_Surface* pBackBuffer) const noexcept;
+    //Rasterizes the scene into the current back buffer, runs as a job
+    void RasterizeSoftwareFrame() const;
     
     /*D3D*/
     ID3D11Device* m_pDevice;
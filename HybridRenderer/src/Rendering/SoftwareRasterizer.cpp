@@ -0,0 +1,151 @@
+#include "pch.h"
+#include "Rendering/SoftwareRasterizer.hpp"
+
+#include <chrono>
+#include <limits>
+
+#include "Geometry/Mesh.hpp"
+#include "Helpers/AllocationCounter.hpp"
+#include "Helpers/FrameArena.hpp"
+#include "Helpers/JobSystem.hpp"
+#include "Rendering/Camera.hpp"
+#include "Rendering/TileBinner.hpp"
+#include "Scene/SceneGraph.hpp"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+}
+
+SoftwareRasterizer::SoftwareRasterizer(const uint32_t width, const uint32_t height, const uint32_t tileSize)
+    : m_Width(width),
+      m_Height(height),
+      m_pSceneGraph(SceneGraph::GetInstance()),
+      m_HiZWidth((width + HiZBlockSize - 1) / HiZBlockSize),
+      m_HiZHeight((height + HiZBlockSize - 1) / HiZBlockSize),
+      m_SampleStride((width + bsimd::SpanWidth - 1) / bsimd::SpanWidth * bsimd::SpanWidth)
+{
+    // Depth and visibility are sized for multisampling
+    const auto sampleBufferSize = m_SampleStride * m_Height * bgh::SampleCount;
+    m_pDepthBuffer = new float[sampleBufferSize];
+    m_pHiZBuffer = new float[m_HiZWidth * m_HiZHeight];
+    m_pVisibilityBuffer = new uint32_t[sampleBufferSize];
+    m_pSampleColorBuffer = new uint32_t[sampleBufferSize];
+    m_pAccumulationBuffer = new glm::vec4[m_Width * m_Height];
+    m_pRevealageBuffer = new float[m_Width * m_Height];
+
+    // Tile binning, with the arena that holds the per frame data of the tiles
+    m_pFrameArena = new FrameArena();
+    m_pTileBinner = new TileBinner(m_Width, m_Height, tileSize);
+}
+
+SoftwareRasterizer::~SoftwareRasterizer()
+{
+    SafeDelete(m_pTileBinner);
+    SafeDelete(m_pFrameArena);
+    delete[] m_pDepthBuffer;
+    delete[] m_pHiZBuffer;
+    delete[] m_pVisibilityBuffer;
+    delete[] m_pSampleColorBuffer;
+    delete[] m_pAccumulationBuffer;
+    delete[] m_pRevealageBuffer;
+}
+
+#pragma region Workers
+void SoftwareRasterizer::Render(uint32_t* pPixels, const bsimd::PackedFormat& packedFormat) const
+{
+    // Everything transient comes from the frame arena, so from here until the blend the heap should stay untouched.
+    // Only this function is counted, the scene update and presenting the frame are not.
+    const auto allocationsBefore = AllocationCounter::GetAllocationCount();
+
+    // Every stage ends where the next one starts
+    SoftwareStageTimes stageTimes{};
+    auto stageStart = Clock::now();
+    const auto endStage = [&stageStart](float& stageMs)
+    {
+        const auto now = Clock::now();
+        stageMs = std::chrono::duration<float, std::milli>(now - stageStart).count();
+        stageStart = now;
+    };
+
+    const auto clearColor = RGBColor(128.f, 128.f, 128.f);
+
+    // Multisampled, depth and visibility hold a value per sample
+    const auto isMultisampled = m_pSceneGraph->GetSoftwareAntiAliasing() != SoftwareAntiAliasing::None;
+    const auto valueCount = isMultisampled ? m_SampleStride * m_Height * bgh::SampleCount : m_Width * m_Height;
+    std::fill_n(m_pDepthBuffer, valueCount, std::numeric_limits<float>::infinity());
+    std::fill_n(m_pHiZBuffer, m_HiZWidth * m_HiZHeight, std::numeric_limits<float>::infinity());
+
+    const auto clearPixel = bsimd::PackColor(clearColor / 255.f, packedFormat);
+    std::fill_n(pPixels, m_Width * m_Height, clearPixel);
+    endStage(stageTimes.clear);
+
+    // The scene update ran on the workers while the caller was busy with other things
+    JobSystem::GetInstance()->Wait(m_pSceneGraph->GetUpdateCounter());
+    endStage(stageTimes.updateWait);
+
+    // Bin all triangles of the scene, then rasterize the tiles in parallel
+    m_pTileBinner->Clear(*m_pFrameArena);
+    for (auto pObject : m_pSceneGraph->GetCurrentSceneObjects())
+    {
+        m_pSceneGraph->GetCamera()->MakeScreenSpace(pObject, *m_pFrameArena);
+        pObject->Bin(*m_pTileBinner);
+    }
+    endStage(stageTimes.transformBin);
+
+    // Setup runs on the workers while this thread clears the buffers the tiles write, Rasterize picks up once both are done
+    m_pTileBinner->Setup();
+    FrameBuffer frameBuffer{pPixels, packedFormat, m_pDepthBuffer, m_Width, m_Height, m_pHiZBuffer, m_HiZWidth};
+    if (isMultisampled)
+    {
+        frameBuffer.sampleCount = bgh::SampleCount;
+        frameBuffer.sampleStride = m_SampleStride;
+        frameBuffer.pSampleColors = m_pSampleColorBuffer;
+    }
+
+    // Visibility buffer mode only stores triangle ids while rasterizing, every pixel is shaded once afterwards
+    const auto isDeferred = m_pSceneGraph->GetSoftwareShadingMode() == SoftwareShadingMode::VisibilityBuffer;
+    if (isDeferred)
+    {
+        std::fill_n(m_pVisibilityBuffer, valueCount, 0u);
+        frameBuffer.pVisibility = m_pVisibilityBuffer;
+    }
+    else if (isMultisampled)
+    {
+        std::fill_n(m_pSampleColorBuffer, valueCount, clearPixel);
+    }
+
+    // Depth pre-pass mode first lays down the final depth, the shading pass then only shades the fragments that match it
+    if (m_pSceneGraph->GetSoftwareShadingMode() == SoftwareShadingMode::DepthPrePass)
+    {
+        frameBuffer.pass = RasterPass::DepthOnly;
+        m_pTileBinner->Rasterize(frameBuffer);
+        frameBuffer.pass = RasterPass::ShadeEqual;
+    }
+
+    m_pTileBinner->Rasterize(frameBuffer);
+    endStage(stageTimes.rasterize);
+    if (isDeferred)
+        m_pTileBinner->Resolve(frameBuffer);
+    else if (isMultisampled)
+        m_pTileBinner->ResolveSamples(frameBuffer);
+    endStage(stageTimes.resolve);
+
+    // Blended surfaces go last, on top of the final opaque colors and depth
+    frameBuffer.pass = RasterPass::Blend;
+    frameBuffer.pAccumulation = m_pAccumulationBuffer;
+    frameBuffer.pRevealage = m_pRevealageBuffer;
+    m_pTileBinner->Blend(frameBuffer);
+    endStage(stageTimes.blend);
+
+    m_pSceneGraph->SetSoftwareFrameStats(AllocationCounter::GetAllocationCount() - allocationsBefore, m_pFrameArena->GetUsedBytes(), stageTimes);
+    m_pFrameArena->Reset();
+}
+#pragma endregion
+
+#pragma region Setters
+void SoftwareRasterizer::Configure(const uint32_t tileSize)
+{
+    m_pTileBinner->Configure(tileSize);
+}
+#pragma endregion
@@ -0,0 +1,52 @@
+#ifndef SOFTWARE_RASTERIZER_HPP
+#define SOFTWARE_RASTERIZER_HPP
+
+//Project includes
+#include "Rendering/FrameBuffer.hpp"
+
+class FrameArena;
+class SceneGraph;
+class TileBinner;
+
+//Owns every buffer of the software pipeline except the pixels, those belong to whoever presents the frame.
+//Depth, visibility and the blending buffers are only used while rasterizing, so one set serves any number of back buffers.
+//The windowed renderer rasterizes into its SDL surfaces with it, the headless one into an offscreen image.
+class SoftwareRasterizer final
+{
+public:
+    SoftwareRasterizer(uint32_t width, uint32_t height, uint32_t tileSize);
+    ~SoftwareRasterizer();
+
+    DEL_ROF(SoftwareRasterizer)
+
+    //Workers
+    //Transforms, bins and rasterizes the current scene into width * height pixels of the given format, waits on the scene update first
+    void Render(uint32_t* pPixels, const bsimd::PackedFormat& packedFormat) const;
+
+    //Setters
+    //Only while no frame is rasterizing
+    void Configure(uint32_t tileSize);
+
+    //Getters
+    [[nodiscard]] constexpr auto GetWidth() const noexcept -> uint32_t { return m_Width; }
+    [[nodiscard]] constexpr auto GetHeight() const noexcept -> uint32_t { return m_Height; }
+
+private:
+    uint32_t m_Width;
+    uint32_t m_Height;
+    SceneGraph* m_pSceneGraph;
+
+    float* m_pDepthBuffer;
+    float* m_pHiZBuffer;
+    uint32_t m_HiZWidth;
+    uint32_t m_HiZHeight;
+    uint32_t* m_pVisibilityBuffer;
+    uint32_t* m_pSampleColorBuffer;
+    uint32_t m_SampleStride; // rows of the sample buffers are padded to whole spans
+    glm::vec4* m_pAccumulationBuffer;
+    float* m_pRevealageBuffer;
+    TileBinner* m_pTileBinner;
+    FrameArena* m_pFrameArena;
+};
+
+#endif // !SOFTWARE_RASTERIZER_HPP
@@ -0,0 +1,289 @@
+#include "pch.h"
+#include "Rendering/TileBinner.hpp"
+
+#include "Geometry/Mesh.hpp"
+
+TileBinner::TileBinner(const uint32_t width, const uint32_t height, const uint32_t tileSize)
+    : m_Width(width),
+      m_Height(height),
+      m_TileSize(),
+      m_TilesX(),
+      m_TilesY(),
+      m_pFrameArena(nullptr)
+{
+    Configure(tileSize);
+}
+
+TileBinner::~TileBinner()
+{
+    // Setup jobs refer to the triangles of this binner
+    JobSystem::GetInstance()->Wait(m_SetupCounter);
+}
+
+#pragma region Workers
+void TileBinner::Clear(FrameArena& frameArena) noexcept
+{
+    JobSystem::GetInstance()->Wait(m_SetupCounter);
+    m_pFrameArena = &frameArena;
+    m_Triangles.Reset(m_pFrameArena);
+    for (auto& bin : m_Bins)
+    {
+        bin.Reset(m_pFrameArena);
+    }
+    for (auto& bin : m_BlendBins)
+    {
+        bin.Reset(m_pFrameArena);
+    }
+}
+
+void TileBinner::Bin(const Mesh* pMesh, const uint32_t firstIndex, const glm::vec2& minPoint, const glm::vec2& maxPoint, const bool isBlended)
+{
+    // Completely off-screen
+    if (maxPoint.x < 0.f || maxPoint.y < 0.f || minPoint.x >= static_cast<float>(m_Width) || minPoint.y >= static_cast<float>(m_Height))
+        return;
+
+    const auto minTileX = static_cast<uint32_t>(std::max(0.f, minPoint.x)) / m_TileSize;
+    const auto minTileY = static_cast<uint32_t>(std::max(0.f, minPoint.y)) / m_TileSize;
+    const auto maxTileX = std::min(static_cast<uint32_t>(maxPoint.x) / m_TileSize, m_TilesX - 1);
+    const auto maxTileY = std::min(static_cast<uint32_t>(maxPoint.y) / m_TileSize, m_TilesY - 1);
+
+    const auto triangleIdx = m_Triangles.GetSize();
+    m_Triangles.PushBack({pMesh, firstIndex, {}, false});
+
+    auto& bins = isBlended ? m_BlendBins : m_Bins;
+    for (auto tileY = minTileY; tileY <= maxTileY; ++tileY)
+    {
+        for (auto tileX = minTileX; tileX <= maxTileX; ++tileX)
+        {
+            bins[tileX + tileY * m_TilesX].PushBack(triangleIdx);
+        }
+    }
+}
+
+void TileBinner::Setup()
+{
+    // Small batches, one job per triangle would spend more time on the job counter than on the setup
+    constexpr uint32_t batchSize = 64;
+    const auto triangleCount = m_Triangles.GetSize();
+
+    // The jobs outlive this call, so they capture by value
+    JobSystem::GetInstance()->ScheduleFor((triangleCount + batchSize - 1) / batchSize, [this, triangleCount](const uint32_t batchIdx)
+    {
+        const auto last = std::min(triangleCount, (batchIdx + 1) * batchSize);
+        for (auto triangleIdx = batchIdx * batchSize; triangleIdx < last; ++triangleIdx)
+        {
+            auto& triangle = m_Triangles[triangleIdx];
+            triangle.hasArea = triangle.pMesh->SetupTriangle(triangle.firstIndex, triangle.setup);
+        }
+    }, m_SetupCounter);
+}
+
+void TileBinner::Rasterize(const FrameBuffer& frameBuffer) const
+{
+    // Tiles only start once every triangle is set up, the calling thread helps with whatever is left of both
+    auto* pJobSystem = JobSystem::GetInstance();
+    JobCounter tilesCounter;
+    pJobSystem->ScheduleFor(GetTileCount(), [&, this](const uint32_t tileIdx)
+    {
+        const auto tileRect = GetTileRect(tileIdx);
+
+        // Triangles are kept in submission order per tile, so the result matches a serial render
+        for (const auto triangleIdx : m_Bins[tileIdx])
+        {
+            const auto& triangle = m_Triangles[triangleIdx];
+            if (triangle.hasArea)
+                triangle.pMesh->RasterizeTriangle(triangle.setup, triangleIdx + 1, tileRect, frameBuffer);
+        }
+    }, tilesCounter, &m_SetupCounter);
+    pJobSystem->Wait(tilesCounter);
+}
+
+void TileBinner::Resolve(const FrameBuffer& frameBuffer) const
+{
+    JobSystem::GetInstance()->ParallelFor(m_Height, [&, this](const uint32_t y)
+    {
+        // Rows are shaded a span at a time so the colors can be packed 8 pixels per store
+        for (uint32_t spanX = 0; spanX < m_Width; spanX += bsimd::SpanWidth)
+        {
+            const auto spanStart = spanX + y * m_Width;
+            const auto laneCount = std::min(bsimd::SpanWidth, m_Width - spanX);
+
+            uint32_t laneMask = 0;
+            float spanRed[bsimd::SpanWidth]{}, spanGreen[bsimd::SpanWidth]{}, spanBlue[bsimd::SpanWidth]{};
+            for (uint32_t lane = 0; lane < laneCount; ++lane)
+            {
+                // Pixel centers sit at .5
+                const auto pixel = glm::vec2(static_cast<float>(spanX + lane) + 0.5f, static_cast<float>(y) + 0.5f);
+                RGBColor finalColor;
+                if (frameBuffer.sampleCount > 1)
+                {
+                    if (!ShadeSamples(frameBuffer, spanX + lane, y, pixel, finalColor))
+                        continue;
+                }
+                else
+                {
+                    const auto visibilityId = frameBuffer.pVisibility[spanStart + lane];
+                    if (visibilityId == 0)
+                        continue;
+
+                    const auto& triangle = m_Triangles[visibilityId - 1];
+                    finalColor = triangle.pMesh->ShadeFragment(triangle.setup, pixel, frameBuffer.pDepth[spanStart + lane]);
+                }
+                spanRed[lane] = finalColor.r;
+                spanGreen[lane] = finalColor.g;
+                spanBlue[lane] = finalColor.b;
+                laneMask |= 1u << lane;
+            }
+
+            if (laneMask == 0)
+                continue;
+
+            uint32_t spanColors[bsimd::SpanWidth];
+            bsimd::PackColorSpan(spanRed, spanGreen, spanBlue, frameBuffer.format, spanColors);
+            bsimd::StoreMasked(frameBuffer.pPixels + spanStart, spanColors, laneMask);
+        }
+    });
+}
+
+void TileBinner::ResolveSamples(const FrameBuffer& frameBuffer) const
+{
+    JobSystem::GetInstance()->ParallelFor(m_Height, [&, this](const uint32_t y)
+    {
+        uint32_t spanColors[bsimd::SpanWidth];
+        for (uint32_t spanX = 0; spanX < m_Width; spanX += bsimd::SpanWidth)
+        {
+            // Rows of the sample buffer are padded to whole spans, only the last span of a row can be partial
+            bsimd::ResolveSpan4x(frameBuffer.pSampleColors + frameBuffer.GetSampleIdx(spanX, y), spanColors);
+            std::copy_n(spanColors, std::min(bsimd::SpanWidth, m_Width - spanX), frameBuffer.pPixels + spanX + y * m_Width);
+        }
+    });
+}
+
+void TileBinner::Blend(const FrameBuffer& frameBuffer) const
+{
+    JobSystem::GetInstance()->ParallelFor(GetTileCount(), [&, this](const uint32_t tileIdx)
+    {
+        const auto& bin = m_BlendBins[tileIdx];
+        if (bin.GetSize() == 0)
+            return;
+
+        // Only tiles with blended triangles touch the accumulation buffers, they're cleared here instead of every frame
+        const auto tileRect = GetTileRect(tileIdx);
+        for (auto y = tileRect.minY; y < tileRect.maxY; ++y)
+        {
+            const auto rowStart = tileRect.minX + y * m_Width;
+            std::fill_n(frameBuffer.pAccumulation + rowStart, tileRect.maxX - tileRect.minX, glm::vec4(0.f));
+            std::fill_n(frameBuffer.pRevealage + rowStart, tileRect.maxX - tileRect.minX, 1.f);
+        }
+
+        // Accumulation is additive, so the order the triangles come in doesn't matter and nothing has to be sorted
+        for (const auto triangleIdx : bin)
+        {
+            const auto& triangle = m_Triangles[triangleIdx];
+            if (triangle.hasArea)
+                triangle.pMesh->RasterizeTriangle(triangle.setup, triangleIdx + 1, tileRect, frameBuffer);
+        }
+
+        // Composite the weighted average of the blended fragments over the opaque color, a span at a time like the other passes
+        for (auto y = tileRect.minY; y < tileRect.maxY; ++y)
+        {
+            for (auto spanX = tileRect.minX; spanX < tileRect.maxX; spanX += bsimd::SpanWidth)
+            {
+                const auto spanStart = spanX + y * m_Width;
+                const auto laneCount = std::min(bsimd::SpanWidth, tileRect.maxX - spanX);
+
+                uint32_t laneMask = 0;
+                float spanRed[bsimd::SpanWidth]{}, spanGreen[bsimd::SpanWidth]{}, spanBlue[bsimd::SpanWidth]{};
+                for (uint32_t lane = 0; lane < laneCount; ++lane)
+                {
+                    const auto revealage = frameBuffer.pRevealage[spanStart + lane];
+                    if (revealage == 1.f)
+                        continue;
+
+                    const auto& accumulation = frameBuffer.pAccumulation[spanStart + lane];
+                    const auto blended = glm::vec3(accumulation) / std::max(accumulation.a, 1e-5f);
+                    const auto opaque = bsimd::UnpackColor(frameBuffer.pPixels[spanStart + lane], frameBuffer.format);
+                    const auto finalColor = blended * (1.f - revealage) + opaque * revealage;
+                    spanRed[lane] = finalColor.r;
+                    spanGreen[lane] = finalColor.g;
+                    spanBlue[lane] = finalColor.b;
+                    laneMask |= 1u << lane;
+                }
+
+                if (laneMask == 0)
+                    continue;
+
+                uint32_t spanColors[bsimd::SpanWidth];
+                bsimd::PackColorSpan(spanRed, spanGreen, spanBlue, frameBuffer.format, spanColors);
+                bsimd::StoreMasked(frameBuffer.pPixels + spanStart, spanColors, laneMask);
+            }
+        }
+    });
+}
+#pragma endregion
+
+#pragma region Helpers
+bool TileBinner::ShadeSamples(const FrameBuffer& frameBuffer, const uint32_t x, const uint32_t y, const glm::vec2& pixel, RGBColor& color) const noexcept
+{
+    const auto sampleIdx = frameBuffer.GetSampleIdx(x, y);
+    uint32_t sampleIds[bgh::SampleCount];
+    RGBColor sampleColors[bgh::SampleCount];
+
+    auto isCovered = false;
+    color = RGBColor(0.f);
+    for (uint32_t sample = 0; sample < bgh::SampleCount; ++sample)
+    {
+        const auto samplePos = sampleIdx + sample * bsimd::SpanWidth;
+        sampleIds[sample] = frameBuffer.pVisibility[samplePos];
+        isCovered |= sampleIds[sample] != 0;
+
+        // Every triangle in the pixel is shaded once, samples it won before reuse that color
+        const auto* pMatch = std::find(sampleIds, sampleIds + sample, sampleIds[sample]);
+        if (pMatch != sampleIds + sample)
+        {
+            sampleColors[sample] = sampleColors[pMatch - sampleIds];
+        }
+        else if (sampleIds[sample] == 0)
+        {
+            sampleColors[sample] = bsimd::UnpackColor(frameBuffer.pPixels[x + y * m_Width], frameBuffer.format);
+        }
+        else
+        {
+            const auto& triangle = m_Triangles[sampleIds[sample] - 1];
+            sampleColors[sample] = triangle.pMesh->ShadeFragment(triangle.setup, pixel, frameBuffer.pDepth[samplePos]);
+        }
+        color += sampleColors[sample];
+    }
+    color /= static_cast<float>(bgh::SampleCount);
+    return isCovered;
+}
+#pragma endregion
+
+#pragma region Setters
+void TileBinner::Configure(const uint32_t tileSize)
+{
+    // Tiles have to own whole hierarchical Z blocks, otherwise two jobs could update the same block
+    m_TileSize = std::max(HiZBlockSize, tileSize / HiZBlockSize * HiZBlockSize);
+    m_TilesX = (m_Width + m_TileSize - 1) / m_TileSize;
+    m_TilesY = (m_Height + m_TileSize - 1) / m_TileSize;
+    m_Bins.clear();
+    m_Bins.resize(GetTileCount());
+    m_BlendBins.clear();
+    m_BlendBins.resize(GetTileCount());
+}
+#pragma endregion
+
+#pragma region Getters
+TileRect TileBinner::GetTileRect(const uint32_t tileIdx) const noexcept
+{
+    const auto tileX = tileIdx % m_TilesX;
+    const auto tileY = tileIdx / m_TilesX;
+
+    TileRect rect{};
+    rect.minX = tileX * m_TileSize;
+    rect.minY = tileY * m_TileSize;
+    rect.maxX = std::min(rect.minX + m_TileSize, m_Width);
+    rect.maxY = std::min(rect.minY + m_TileSize, m_Height);
+    return rect;
+}
+#pragma endregion
@@ -0,0 +1,79 @@
+#ifndef TILE_BINNER_HPP
+#define TILE_BINNER_HPP
+
+//Standard includes
+#include <vector>
+
+//Project includes
+#include "Helpers/FrameArena.hpp"
+#include "Helpers/JobSystem.hpp"
+#include "Rendering/FrameBuffer.hpp"
+#include "Rendering/TriangleSetup.hpp"
+
+class Mesh;
+
+struct BinnedTriangle
+{
+    const Mesh* pMesh;
+    uint32_t firstIndex;
+    TriangleSetup setup;   // filled in by the setup jobs queued in Setup
+    bool hasArea;
+};
+
+//Sorts screen space triangles into fixed size screen tiles, tiles are then rasterized in parallel.
+//Every tile is owned by exactly one job, so the pixel and depth buffers need no locking.
+//With a visibility buffer bound the tiles only store triangle ids, Resolve then shades every pixel once, split over rows.
+//Multisampled, Resolve shades every triangle in a pixel once and averages the samples, forward shading averages the sample colors in ResolveSamples.
+//Triangles are set up once before rasterizing, no matter how many tiles they overlap. Setup only queues that work, the tiles wait on it in the job graph so the caller can do other work in between.
+//Blended triangles are kept in separate bins, Blend accumulates them per tile after the opaque passes and composites the tile right away.
+//Triangles and bins live in the frame arena passed to Clear, they are only valid until that arena resets.
+class TileBinner final
+{
+public:
+    TileBinner(uint32_t width, uint32_t height, uint32_t tileSize);
+    ~TileBinner();
+
+    DEL_ROF(TileBinner)
+
+    //Workers
+    void Clear(FrameArena& frameArena) noexcept;
+    void Bin(const Mesh* pMesh, uint32_t firstIndex, const glm::vec2& minPoint, const glm::vec2& maxPoint, bool isBlended = false);
+    //Queues the triangle setup, Rasterize waits for it
+    void Setup();
+    void Rasterize(const FrameBuffer& frameBuffer) const;
+    void Resolve(const FrameBuffer& frameBuffer) const;
+    //Averages the sample colors of a multisampled frame into its pixels
+    void ResolveSamples(const FrameBuffer& frameBuffer) const;
+    //Weighted blended order independent transparency, needs the accumulation buffers of the frame buffer and the final opaque colors in its pixels
+    void Blend(const FrameBuffer& frameBuffer) const;
+
+    //Setters
+    void Configure(uint32_t tileSize);
+
+    //Getters
+    [[nodiscard]] constexpr auto GetWidth() const noexcept -> uint32_t { return m_Width; }
+    [[nodiscard]] constexpr auto GetHeight() const noexcept -> uint32_t { return m_Height; }
+    [[nodiscard]] constexpr auto GetTileSize() const noexcept -> uint32_t { return m_TileSize; }
+    [[nodiscard]] constexpr auto GetTileCount() const noexcept -> uint32_t { return m_TilesX * m_TilesY; }
+    [[nodiscard]] auto GetTileRect(uint32_t tileIdx) const noexcept -> TileRect;
+    [[nodiscard]] auto GetFrameArena() const noexcept -> FrameArena& { return *m_pFrameArena; }
+
+private:
+    uint32_t m_Width;
+    uint32_t m_Height;
+    uint32_t m_TileSize;
+    uint32_t m_TilesX;
+    uint32_t m_TilesY;
+
+    //Every triangle is stored once, bins refer to it by index so the index doubles as its visibility id
+    ArenaVector<BinnedTriangle> m_Triangles;
+    std::vector<ArenaVector<uint32_t>> m_Bins;
+    std::vector<ArenaVector<uint32_t>> m_BlendBins;
+    mutable JobCounter m_SetupCounter;
+    FrameArena* m_pFrameArena;
+
+    //Shades the triangles that won the samples of a pixel in a multisampled visibility buffer, false if none did
+    [[nodiscard]] bool ShadeSamples(const FrameBuffer& frameBuffer, uint32_t x, uint32_t y, const glm::vec2& pixel, RGBColor& color) const noexcept;
+};
+
+#endif // !TILE_BINNER_HPP
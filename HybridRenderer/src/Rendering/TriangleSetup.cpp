@@ -0,0 +1,86 @@
+#include "pch.h"
+#include "Rendering/TriangleSetup.hpp"
+
+bool TriangleSetup::Setup(const VertexOutput& v0, const VertexOutput& v1, const VertexOutput& v2) noexcept
+{
+    if (!bgh::SetupTriangleEdges(glm::vec2(v0.pos), glm::vec2(v1.pos), glm::vec2(v2.pos), triEdges))
+        return false;
+
+    // Screen space gradients follow from the two edges leaving the first vertex.
+    // They use the snapped triangle the edges test against, so every covered pixel center interpolates inside the triangle, even for slivers.
+    // The snapped coordinates are exact in double, so the determinant is too and it can't be zero once the snapped area isn't.
+    origin = bgh::SnapToSubPixel(glm::vec2(v0.pos));
+    const auto edge1 = bgh::SnapToSubPixel(glm::vec2(v1.pos)) - origin;
+    const auto edge2 = bgh::SnapToSubPixel(glm::vec2(v2.pos)) - origin;
+    const auto invDet = static_cast<float>(1.0 / (static_cast<double>(edge1.x) * edge2.y - static_cast<double>(edge1.y) * edge2.x));
+
+    // Depth is interpolated linearly, only the other attributes need the perspective divide
+    const auto depth1 = v1.pos.z - v0.pos.z;
+    const auto depth2 = v2.pos.z - v0.pos.z;
+    depth = {v0.pos.z, (depth1 * edge2.y - depth2 * edge1.y) * invDet, (depth2 * edge1.x - depth1 * edge2.x) * invDet};
+    for (uint32_t sample = 0; sample < bgh::SampleCount; ++sample)
+    {
+        const auto position = glm::vec2(bgh::SamplePositions[sample]) / 16.f;
+        sampleDepthOffsets[sample] = depth.ddx * position.x + depth.ddy * position.y;
+    }
+    minDepth = std::min(v0.pos.z, std::min(v1.pos.z, v2.pos.z));
+    maxDepth = std::max(v0.pos.z, std::max(v1.pos.z, v2.pos.z));
+
+    const auto invW0 = 1.f / v0.pos.w;
+    const auto invW1 = 1.f / v1.pos.w;
+    const auto invW2 = 1.f / v2.pos.w;
+
+    const auto makePlane = [&](const auto& a0, const auto& a1, const auto& a2)
+    {
+        using Attribute = std::decay_t<decltype(a0)>;
+        const Attribute q0 = a0 * invW0;
+        const Attribute delta1 = a1 * invW1 - q0;
+        const Attribute delta2 = a2 * invW2 - q0;
+        return AttributePlane<Attribute>{
+            q0,
+            (delta1 * edge2.y - delta2 * edge1.y) * invDet,
+            (delta2 * edge1.x - delta1 * edge2.x) * invDet
+        };
+    };
+
+    invW = makePlane(1.f, 1.f, 1.f);
+    worldPos = makePlane(v0.worldPos, v1.worldPos, v2.worldPos);
+    uv = makePlane(v0.uv, v1.uv, v2.uv);
+    normal = makePlane(v0.normal, v1.normal, v2.normal);
+    tangent = makePlane(v0.tangent, v1.tangent, v2.tangent);
+    viewDirection = makePlane(v0.viewDirection, v1.viewDirection, v2.viewDirection);
+    return true;
+}
+
+glm::vec2 TriangleSetup::SpanDepth(const uint32_t x, const uint32_t y) const noexcept
+{
+    const auto pixel = glm::vec2(static_cast<float>(x) + 0.5f, static_cast<float>(y) + 0.5f);
+    return {depth.Evaluate(pixel - origin), depth.ddx};
+}
+
+VertexOutput TriangleSetup::Interpolate(const glm::vec2& screenPos) const noexcept
+{
+    const auto offset = screenPos - origin;
+    const auto w = 1.f / invW.Evaluate(offset);
+
+    VertexOutput vReturn{};
+    vReturn.worldPos = worldPos.Evaluate(offset) * w;
+    vReturn.uv = uv.Evaluate(offset) * w;
+    vReturn.normal = normal.Evaluate(offset) * w;
+    vReturn.tangent = tangent.Evaluate(offset) * w;
+    vReturn.viewDirection = viewDirection.Evaluate(offset) * w;
+
+    // Like a GPU, derivatives are shared by the 2x2 quad the pixel is in, the planes give the quad's other pixels for free
+    const auto quadOffset = glm::floor(screenPos * 0.5f) * 2.f + 0.5f - origin;
+    const auto uvAt = [this](const glm::vec2& at) { return uv.Evaluate(at) / invW.Evaluate(at); };
+    const auto quadUV = uvAt(quadOffset);
+    vReturn.uvDx = uvAt(quadOffset + glm::vec2(1.f, 0.f)) - quadUV;
+    vReturn.uvDy = uvAt(quadOffset + glm::vec2(0.f, 1.f)) - quadUV;
+    return vReturn;
+}
+
+glm::vec3 TriangleSetup::InterpolateNormal(const glm::vec2& screenPos) const noexcept
+{
+    const auto offset = screenPos - origin;
+    return normal.Evaluate(offset) / invW.Evaluate(offset);
+}
@@ -0,0 +1,55 @@
+#ifndef TRIANGLE_SETUP_HPP
+#define TRIANGLE_SETUP_HPP
+
+//Project includes
+#include "Helpers/GeometryHelpers.hpp"
+#include "Helpers/Vertex.hpp"
+
+//Screen space plane of an attribute, evaluated relative to the first vertex of the triangle
+template <typename Attribute>
+struct AttributePlane
+{
+    Attribute origin;
+    Attribute ddx;
+    Attribute ddy;
+
+    [[nodiscard]] constexpr auto Evaluate(const glm::vec2& offset) const noexcept -> Attribute { return origin + ddx * offset.x + ddy * offset.y; }
+};
+
+//Everything that only depends on the triangle, computed once so interpolating a pixel is a handful of FMAs.
+//Attribute planes hold the attribute divided by w, dividing by the interpolated 1/w makes them perspective correct.
+struct TriangleSetup
+{
+    /*Rasterization*/
+    bgh::TriangleEdges triEdges;
+    AttributePlane<float> depth;                // NDC z is affine in screen space, so it is a plane of its own without the divide by w
+    float sampleDepthOffsets[bgh::SampleCount]; // added to the depth at a pixel center this gives the depth at each sample
+    float minDepth;                             // closest vertex depth, the interpolated depth is clamped to the vertices' range
+    float maxDepth;                             // so it never gets closer than this, which hierarchical Z relies on
+
+    /*Interpolation*/
+    glm::vec2 origin;       // snapped screen position of the first vertex
+    AttributePlane<float> invW;
+    AttributePlane<glm::vec3> worldPos;
+    AttributePlane<glm::vec2> uv;
+    AttributePlane<glm::vec3> normal;
+    AttributePlane<glm::vec3> tangent;
+    AttributePlane<glm::vec3> viewDirection;
+
+    /**
+     * Sets up the edges and attribute planes of a screen space triangle
+     * @return false if the triangle has no area once snapped, nothing else is set up in that case
+     * */
+    [[nodiscard]] auto Setup(const VertexOutput& v0, const VertexOutput& v1, const VertexOutput& v2) noexcept -> bool;
+
+    //Depth at the center of pixel (x, y) and its step per pixel in x, the start of a span for the depth tests
+    [[nodiscard]] auto SpanDepth(uint32_t x, uint32_t y) const noexcept -> glm::vec2;
+    //Range the interpolated depth is clamped to
+    [[nodiscard]] auto DepthRange() const noexcept -> glm::vec2 { return {minDepth, maxDepth}; }
+    //Perspective correct attributes and uv derivatives at a screen position, pixel centers sit at .5
+    [[nodiscard]] auto Interpolate(const glm::vec2& screenPos) const noexcept -> VertexOutput;
+    //Only the perspective correct normal, for kernels that need nothing else
+    [[nodiscard]] auto InterpolateNormal(const glm::vec2& screenPos) const noexcept -> glm::vec3;
+};
+
+#endif // !TRIANGLE_SETUP_HPP
@@ -0,0 +1,93 @@
+#include "pch.h"
+#include "Scene/CameraPath.hpp"
+
+#include <glm/gtc/constants.hpp>
+
+#include "Debugging/Logger.hpp"
+
+#pragma region Workers
+bool CameraPath::Load(const std::string_view pathName)
+{
+    m_Keyframes.clear();
+
+    // Same start as the windowed renderer
+    const glm::vec3 start{0, 5, 65};
+    const glm::vec3 target{0, 0, 0};
+    if (pathName == "turntable")
+    {
+        m_Keyframes.push_back({0.f, start, 0.f, 0.f, true});
+    }
+    else if (pathName == "orbit")
+    {
+        // Enough keyframes that the straight pieces between them stay close to the circle
+        constexpr uint32_t keyframeCount = 64;
+        constexpr auto duration = 10.f;
+        const auto radius = glm::length(glm::vec2(start.x, start.z));
+        for (uint32_t keyframeIdx = 0; keyframeIdx <= keyframeCount; ++keyframeIdx)
+        {
+            const auto progress = static_cast<float>(keyframeIdx) / keyframeCount;
+            const auto angle = progress * glm::two_pi<float>();
+            m_Keyframes.push_back(LookAt(progress * duration, {radius * std::sin(angle), start.y, radius * std::cos(angle)}, target, false));
+        }
+    }
+    else if (pathName == "flythrough")
+    {
+        m_Keyframes.push_back(LookAt(0.f, start, target, false));
+        m_Keyframes.push_back(LookAt(3.f, {0, 4, 22}, target, false));
+        m_Keyframes.push_back(LookAt(5.f, {16, 3, 8}, target, true));
+        m_Keyframes.push_back(LookAt(7.f, {14, 6, -14}, target, true));
+        m_Keyframes.push_back(LookAt(9.f, {-6, 2, -9}, target, true));
+        m_Keyframes.push_back(LookAt(12.f, {-30, 12, 40}, target, false));
+    }
+    else
+    {
+        LOG(LEVEL_ERROR, "Unknown camera path " << pathName)
+        return false;
+    }
+
+    // Yaw comes out of atan2 in [-pi, pi], unwrap it so the camera never turns the long way around between two keyframes
+    for (size_t keyframeIdx = 1; keyframeIdx < m_Keyframes.size(); ++keyframeIdx)
+    {
+        const auto previousYaw = m_Keyframes[keyframeIdx - 1].yaw;
+        auto& yaw = m_Keyframes[keyframeIdx].yaw;
+        while (yaw - previousYaw > glm::pi<float>())
+            yaw -= glm::two_pi<float>();
+        while (yaw - previousYaw < -glm::pi<float>())
+            yaw += glm::two_pi<float>();
+    }
+    return true;
+}
+#pragma endregion
+
+#pragma region Getters
+auto CameraPath::GetPose(const float time) const noexcept -> CameraKeyframe
+{
+    if (m_Keyframes.empty())
+        return {};
+
+    const auto nextIt = std::upper_bound(m_Keyframes.begin(), m_Keyframes.end(), time, [](const float t, const CameraKeyframe& keyframe) { return t < keyframe.time; });
+    if (nextIt == m_Keyframes.begin())
+        return m_Keyframes.front();
+    if (nextIt == m_Keyframes.end())
+        return m_Keyframes.back();
+
+    const auto& previous = *(nextIt - 1);
+    const auto& next = *nextIt;
+    const auto weight = (time - previous.time) / (next.time - previous.time);
+    return {time,
+            glm::mix(previous.position, next.position, weight),
+            glm::mix(previous.pitch, next.pitch, weight),
+            glm::mix(previous.yaw, next.yaw, weight),
+            previous.areObjectsRotating};
+}
+
+auto CameraPath::LookAt(const float time, const glm::vec3& position, const glm::vec3& target, const bool areObjectsRotating) noexcept -> CameraKeyframe
+{
+    // Inverse of the forward vector the software camera builds from its pitch and yaw, looking down -z at zero
+    const auto toTarget = target - position;
+    const auto horizontalDistance = glm::length(glm::vec2(toTarget.x, toTarget.z));
+    const auto pitch = std::atan2(-toTarget.y, horizontalDistance);
+    const auto yaw = std::atan2(toTarget.x, -toTarget.z);
+    return {time, position, pitch, yaw, areObjectsRotating};
+}
+#pragma endregion
@@ -0,0 +1,47 @@
+#ifndef CAMERA_PATH_HPP
+#define CAMERA_PATH_HPP
+
+//Standard includes
+#include <array>
+#include <string_view>
+#include <vector>
+
+//Scripted pose of the camera and whether the objects spin, at a point in time
+struct CameraKeyframe
+{
+    float time = 0.f; // seconds since the start of the path
+    glm::vec3 position{};
+    float pitch = 0.f; // radians, positive looks down
+    float yaw = 0.f;   // radians, not wrapped so a path can turn past a full circle
+    bool areObjectsRotating = false;
+};
+
+//Camera path for benchmarks, played back with a fixed time step so every run sees the same frames.
+//Poses are interpolated linearly between keyframes, rotation switches at a keyframe and the last keyframe holds once the path ends.
+//The paths are built in, so a named path is the same on every machine and build.
+class CameraPath final
+{
+public:
+    //"turntable" keeps the start camera and spins the objects, "orbit" circles the camera around them once,
+    //"flythrough" moves in close and around the objects, triangles get large and cross the near plane
+    static constexpr std::array<std::string_view, 3> PathNames{"turntable", "orbit", "flythrough"};
+
+    CameraPath() = default;
+    ~CameraPath() = default;
+
+    //Workers
+    //Builds the named path, logs and returns false for an unknown name
+    [[nodiscard]] bool Load(std::string_view pathName);
+
+    //Getters
+    [[nodiscard]] auto GetPose(float time) const noexcept -> CameraKeyframe;
+    [[nodiscard]] auto GetDuration() const noexcept -> float { return m_Keyframes.empty() ? 0.f : m_Keyframes.back().time; }
+
+private:
+    std::vector<CameraKeyframe> m_Keyframes; // sorted on time
+
+    //Keyframe looking at the target from the position
+    [[nodiscard]] static auto LookAt(float time, const glm::vec3& position, const glm::vec3& target, bool areObjectsRotating) noexcept -> CameraKeyframe;
+};
+
+#endif // !CAMERA_PATH_HPP
@@ -6,14 +6,17 @@
 #include "Debugging/Logger.hpp"
 #include "Geometry/Mesh.hpp"
 #include "Helpers/magic_enum.hpp"
-#include "Helpers/Timer.hpp"
 #include "Rendering/Camera.hpp"
+#ifndef HYBRID_HEADLESS
+#include "Helpers/Timer.hpp"
 #include "Rendering/Renderer.hpp"
+#endif
 
 Camera* SceneGraph::m_pCamera = nullptr;
 
 SceneGraph::~SceneGraph()
 {
+    JobSystem::GetInstance()->Wait(m_UpdateCounter);
     for (auto pObject : m_Objects)
     {
         SafeDelete(pObject);
@@ -49,7 +52,7 @@ void SceneGraph::ChangeCameraResolution(const uint32_t width, const uint32_t hei
 #pragma endregion
 
 #pragma region Workers
-void SceneGraph::Update(const float dT) const
+void SceneGraph::Update(const float dT)
 {
     float rotationSpeed;
     if (m_AreObjectsRotating)
@@ -61,12 +64,20 @@ void SceneGraph::Update(const float dT) const
         rotationSpeed = 0.f;
     }
 
-    for (const auto pMesh : GetCurrentSceneObjects())
+    // Last frame's renderer already waited on these, this only matters when nothing rendered in between
+    auto* pJobSystem = JobSystem::GetInstance();
+    pJobSystem->Wait(m_UpdateCounter);
+
+    // Every mesh only touches its own transform
+    const auto* pObjects = &GetCurrentSceneObjects();
+    pJobSystem->ScheduleFor(static_cast<uint32_t>(pObjects->size()), [pObjects, dT, rotationSpeed](const uint32_t objectIdx)
     {
-        pMesh->Update(dT, rotationSpeed);
-    }
+        (*pObjects)[objectIdx]->Update(dT, rotationSpeed);
+    }, m_UpdateCounter);
 }
 
+// The settings UI needs ImGui, headless runs pick their settings through the setters
+#ifndef HYBRID_HEADLESS
 void SceneGraph::RenderDebugUI() noexcept
 {
     // ImGui Debug UI
@@ -181,6 +192,91 @@ void SceneGraph::RenderSoftwareDebugUI() noexcept
         ImGui::EndCombo();
     }
 
+    // Software Shading Mode
+    if (ImGui::BeginCombo("Shading Mode", ENUM_TO_C_STR(m_SoftwareShadingMode)))
+    {
+        for (auto [mode, name] : magic_enum::enum_entries<SoftwareShadingMode>())
+        {
+            if (ImGui::Selectable(C_STR_FROM_VIEW(name)) && mode != m_SoftwareShadingMode)
+            {
+                m_SoftwareShadingMode = mode;
+                LOG(LEVEL_INFO, "Shading mode changed to " << magic_enum::enum_name(m_SoftwareShadingMode))
+            }
+        }
+        ImGui::EndCombo();
+    }
+
+    // Software Cull Mode
+    if (ImGui::BeginCombo("Cull Mode", ENUM_TO_C_STR(m_SoftwareCullMode)))
+    {
+        for (auto [mode, name] : magic_enum::enum_entries<SoftwareCullMode>())
+        {
+            if (ImGui::Selectable(C_STR_FROM_VIEW(name)) && mode != m_SoftwareCullMode)
+            {
+                m_SoftwareCullMode = mode;
+                LOG(LEVEL_INFO, "Cull mode changed to " << magic_enum::enum_name(m_SoftwareCullMode))
+            }
+        }
+        ImGui::EndCombo();
+    }
+
+    // Software Anti-Aliasing
+    if (ImGui::BeginCombo("Anti-Aliasing", ENUM_TO_C_STR(m_SoftwareAntiAliasing)))
+    {
+        for (auto [mode, name] : magic_enum::enum_entries<SoftwareAntiAliasing>())
+        {
+            if (ImGui::Selectable(C_STR_FROM_VIEW(name)) && mode != m_SoftwareAntiAliasing)
+            {
+                m_SoftwareAntiAliasing = mode;
+                LOG(LEVEL_INFO, "Anti-aliasing changed to " << magic_enum::enum_name(m_SoftwareAntiAliasing))
+            }
+        }
+        ImGui::EndCombo();
+    }
+
+    // Texture Filtering
+    RenderFilterTypeUI();
+
+    // Tile Binning
+    if (ImGui::BeginCombo("Tile Size", TO_C_STR(m_SoftwareTileSize)))
+    {
+        for (const auto tileSize : {16u, 32u, 64u, 128u})
+        {
+            if (ImGui::Selectable(TO_C_STR(tileSize)) && tileSize != m_SoftwareTileSize)
+            {
+                m_SoftwareTileSize = tileSize;
+                m_ShouldUpdateSoftwarePipeline = true;
+                LOG(LEVEL_INFO, "Tile size changed to " << m_SoftwareTileSize)
+            }
+        }
+        ImGui::EndCombo();
+    }
+
+    // Only apply the thread count once the slider is released, restarting the workers every frame while dragging is pointless
+    auto threadCount = static_cast<int>(m_ThreadCount);
+    const auto maxThreads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    ImGui::SliderInt("Threads", &threadCount, 1, maxThreads);
+    m_ThreadCount = static_cast<uint32_t>(threadCount);
+    if (ImGui::IsItemDeactivatedAfterEdit())
+    {
+        m_ShouldUpdateSoftwarePipeline = true;
+        LOG(LEVEL_INFO, "Thread count changed to " << m_ThreadCount)
+    }
+
+    // Frame Stats, steady state rasterization should not touch the heap from the clear to the blend, the rest of the frame is not counted
+    ImGui::Text((std::string("Rasterization heap allocations: ") + std::to_string(m_RasterizationHeapAllocations)).c_str());
+    ImGui::Text((std::string("Frame arena: ") + std::to_string(m_SoftwareFrameArenaBytes / 1024) + " KB").c_str());
+    if (ImGui::TreeNode("Stage Times (ms)"))
+    {
+        ImGui::BulletText("Clear: %.2f", m_SoftwareStageTimes.clear);
+        ImGui::BulletText("Update wait: %.2f", m_SoftwareStageTimes.updateWait);
+        ImGui::BulletText("Transform and bin: %.2f", m_SoftwareStageTimes.transformBin);
+        ImGui::BulletText("Rasterize: %.2f", m_SoftwareStageTimes.rasterize);
+        ImGui::BulletText("Resolve: %.2f", m_SoftwareStageTimes.resolve);
+        ImGui::BulletText("Blend: %.2f", m_SoftwareStageTimes.blend);
+        ImGui::TreePop();
+    }
+
     // RT Settings
     if (ImGui::Button("Render RT Frame"))
     {
@@ -224,6 +320,12 @@ void SceneGraph::RenderHardwareDebugUI() noexcept
         ImGui::EndCombo();
     }
 
+    RenderFilterTypeUI();
+}
+
+void SceneGraph::RenderFilterTypeUI() noexcept
+{
+    // Shared by both render systems, the software samplers follow the hardware filter setting
     if (ImGui::BeginCombo("Filter Type", ENUM_TO_C_STR(m_HardwareFilterType)))
     {
         for (const auto [type, name] : magic_enum::enum_entries<HardwareFilterType>())
@@ -238,5 +340,6 @@ void SceneGraph::RenderHardwareDebugUI() noexcept
         ImGui::EndCombo();
     }
 }
+#endif
 
 #pragma endregion
@@ -4,8 +4,10 @@
 //Standard Includes
 #include <vector>
 #include <map>
+#include <thread>
 
 //Project includes
+#include "Helpers/JobSystem.hpp"
 #include "Helpers/Singleton.hpp"
 
 class Timer;
@@ -20,6 +22,26 @@ enum class SoftwareRenderType
     NormalMapped = 3
 };
 
+enum class SoftwareShadingMode
+{
+    Forward = 0,
+    VisibilityBuffer = 1,
+    DepthPrePass = 2
+};
+
+enum class SoftwareCullMode
+{
+    Back = 0,
+    Front = 1,
+    None = 2
+};
+
+enum class SoftwareAntiAliasing
+{
+    None = 0,
+    MSAA4x = 1 // coverage and depth per sample, shading once per pixel per triangle
+};
+
 enum class HardwareRenderType
 {
     Color = 0,
@@ -41,6 +63,17 @@ enum RenderSystem
     D3D = 1
 };
 
+//Milliseconds the last software frame spent in each stage
+struct SoftwareStageTimes
+{
+    float clear = 0.f;
+    float updateWait = 0.f;   // waiting for the mesh updates queued by SceneGraph::Update
+    float transformBin = 0.f;
+    float rasterize = 0.f;    // includes waiting for the triangle setup
+    float resolve = 0.f;
+    float blend = 0.f;
+};
+
 class Camera;
 
 class SceneGraph final : public Singleton<SceneGraph>
@@ -50,6 +83,9 @@ public:
     : m_pTimer(nullptr)
     , m_CurrentScene(0)
     , m_SoftwareRenderType(SoftwareRenderType::Color)
+    , m_SoftwareShadingMode(SoftwareShadingMode::Forward)
+    , m_SoftwareCullMode(SoftwareCullMode::Back)
+    , m_SoftwareAntiAliasing(SoftwareAntiAliasing::None)
     , m_HardwareRenderType(HardwareRenderType::Color)
     , m_HardwareFilterType(HardwareFilterType::Point)
     , m_RenderSystem(Software)
@@ -58,7 +94,12 @@ public:
     , m_ShouldUpdateRenderSystem(false)
     , m_ShouldUpdateHardwareTypes(false)
     , m_RenderRTFrame(false)
-    , m_ShowRTRender(false){}
+    , m_ShowRTRender(false)
+    , m_SoftwareTileSize(64)
+    , m_ThreadCount(std::max(1u, std::thread::hardware_concurrency()))
+    , m_ShouldUpdateSoftwarePipeline(false)
+    , m_RasterizationHeapAllocations(0)
+    , m_SoftwareFrameArenaBytes(0){}
     ~SceneGraph();
 
     DEL_ROF(SceneGraph)
@@ -70,18 +111,41 @@ public:
     static void ChangeCameraResolution(uint32_t width, uint32_t height);
 
     //Workers
-    void Update(float dT) const;
+    //Queues the mesh updates on the job system, renderers wait on the update counter before reading the meshes
+    void Update(float dT);
     void RenderDebugUI() noexcept;
     void SetTimer(Timer* pTimer) noexcept { m_pTimer = pTimer; }
     void ConfirmRenderSystemUpdate() noexcept { m_ShouldUpdateRenderSystem = false; }
     void ConfirmHardwareTypesUpdate() noexcept { m_ShouldUpdateHardwareTypes = false; }
     void ConfirmRTRender() noexcept { m_RenderRTFrame = false; }
+    void ConfirmSoftwarePipelineUpdate() noexcept { m_ShouldUpdateSoftwarePipeline = false; }
+    void SetSoftwareFrameStats(const uint64_t rasterizationHeapAllocations, const size_t arenaBytes, const SoftwareStageTimes& stageTimes) noexcept
+    {
+        m_RasterizationHeapAllocations = rasterizationHeapAllocations;
+        m_SoftwareFrameArenaBytes = arenaBytes;
+        m_SoftwareStageTimes = stageTimes;
+    }
+
+    //Setters
+    void SetObjectsRotating(const bool areRotating) noexcept { m_AreObjectsRotating = areRotating; }
+    void SetSoftwareShadingMode(const SoftwareShadingMode shadingMode) noexcept { m_SoftwareShadingMode = shadingMode; }
+    void SetSoftwareAntiAliasing(const SoftwareAntiAliasing antiAliasing) noexcept { m_SoftwareAntiAliasing = antiAliasing; }
+    void SetSoftwareTileSize(const uint32_t tileSize) noexcept
+    {
+        m_SoftwareTileSize = tileSize;
+        m_ShouldUpdateSoftwarePipeline = true;
+    }
+    //Only read when the renderer sets up its pipeline
+    void SetThreadCount(const uint32_t threadCount) noexcept { m_ThreadCount = std::max(1u, threadCount); }
 
     //Getters
     [[nodiscard]] constexpr auto GetObjects() const noexcept -> const std::vector<Mesh*>& { return m_Objects; }
     [[nodiscard]] auto GetCurrentSceneObjects() const noexcept -> const std::vector<Mesh*>& { return m_pScenes.at(m_CurrentScene); }
-    [[nodiscard]] static constexpr auto GetCamera() noexcept -> Camera* { return m_pCamera; }
+    [[nodiscard]] static auto GetCamera() noexcept -> Camera* { return m_pCamera; }
     [[nodiscard]] constexpr auto GetSoftwareRenderType() const noexcept -> SoftwareRenderType { return m_SoftwareRenderType; }
+    [[nodiscard]] constexpr auto GetSoftwareShadingMode() const noexcept -> SoftwareShadingMode { return m_SoftwareShadingMode; }
+    [[nodiscard]] constexpr auto GetSoftwareCullMode() const noexcept -> SoftwareCullMode { return m_SoftwareCullMode; }
+    [[nodiscard]] constexpr auto GetSoftwareAntiAliasing() const noexcept -> SoftwareAntiAliasing { return m_SoftwareAntiAliasing; }
     [[nodiscard]] constexpr auto GetHardwareRenderType() const noexcept -> HardwareRenderType { return m_HardwareRenderType; }
     [[nodiscard]] constexpr auto GetHardwareFilterType() const noexcept -> HardwareFilterType { return m_HardwareFilterType; }
     [[nodiscard]] constexpr auto GetRenderSystem() const noexcept -> RenderSystem { return m_RenderSystem; }
@@ -92,6 +156,12 @@ public:
     [[nodiscard]] constexpr auto ShouldUpdateHardwareTypes() const noexcept -> bool { return m_ShouldUpdateHardwareTypes; }
     [[nodiscard]] constexpr auto ShouldRenderRTFrame() const noexcept -> bool { return m_RenderRTFrame; }
     [[nodiscard]] constexpr auto ShouldShowRTRender() const noexcept -> bool { return m_ShowRTRender; }
+    [[nodiscard]] constexpr auto GetSoftwareTileSize() const noexcept -> uint32_t { return m_SoftwareTileSize; }
+    [[nodiscard]] constexpr auto GetThreadCount() const noexcept -> uint32_t { return m_ThreadCount; }
+    [[nodiscard]] constexpr auto ShouldUpdateSoftwarePipeline() const noexcept -> bool { return m_ShouldUpdateSoftwarePipeline; }
+    [[nodiscard]] constexpr auto GetUpdateCounter() const noexcept -> const JobCounter& { return m_UpdateCounter; }
+    [[nodiscard]] constexpr auto AreObjectsRotating() const noexcept -> bool { return m_AreObjectsRotating; }
+    [[nodiscard]] constexpr auto GetSoftwareStageTimes() const noexcept -> const SoftwareStageTimes& { return m_SoftwareStageTimes; }
 private:
     //Data Members
     std::vector<Mesh*> m_Objects;
@@ -101,6 +171,9 @@ private:
     //Scene Settings
     uint32_t m_CurrentScene;
     SoftwareRenderType m_SoftwareRenderType;
+    SoftwareShadingMode m_SoftwareShadingMode;
+    SoftwareCullMode m_SoftwareCullMode;
+    SoftwareAntiAliasing m_SoftwareAntiAliasing;
     HardwareRenderType m_HardwareRenderType;
     HardwareFilterType m_HardwareFilterType;
     RenderSystem m_RenderSystem;
@@ -110,9 +183,20 @@ private:
     bool m_ShouldUpdateHardwareTypes;
     bool m_RenderRTFrame;
     bool m_ShowRTRender;
+    //Software Pipeline Settings
+    uint32_t m_SoftwareTileSize;
+    uint32_t m_ThreadCount; // threads of the job system, shared by every system
+    bool m_ShouldUpdateSoftwarePipeline;
+    //Software Frame Stats
+    uint64_t m_RasterizationHeapAllocations; // counted over SoftwareRasterizer::Render only
+    size_t m_SoftwareFrameArenaBytes;
+    SoftwareStageTimes m_SoftwareStageTimes;
+    //Mesh updates of the current frame
+    JobCounter m_UpdateCounter;
 
     void RenderSoftwareDebugUI() noexcept;
     void RenderHardwareDebugUI() noexcept;
+    void RenderFilterTypeUI() noexcept;
 
 };
 
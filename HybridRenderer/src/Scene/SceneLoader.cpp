@@ -0,0 +1,52 @@
+#include "pch.h"
+#include "Scene/SceneLoader.hpp"
+
+#include "Debugging/Logger.hpp"
+#include "Geometry/Mesh.hpp"
+#include "Materials/MaterialFlat.hpp"
+#include "Materials/MaterialManager.hpp"
+#include "Materials/MaterialMapped.hpp"
+#include "Materials/TextureLoader.hpp"
+#include "Scene/SceneGraph.hpp"
+
+namespace
+{
+    void LoadVehicle(ID3D11Device* pDevice, const bool hasFireEffect)
+    {
+        //All textures decode and interleave on the job system, only their uploads run serially on this thread
+        TextureLoader textureLoader{};
+        auto* pShipDiffuse = textureLoader.Queue("./Resources/Textures/vehicle_diffuse.png");
+        auto* pShipNormal = textureLoader.Queue("./Resources/Textures/vehicle_normal.png", TextureUsage::Normal);
+        auto* pShipGloss = textureLoader.Queue("./Resources/Textures/vehicle_gloss.png", TextureUsage::Scalar);
+        auto* pShipSpecular = textureLoader.Queue("./Resources/Textures/vehicle_specular.png", TextureUsage::Scalar);
+        auto* pFireDiffuse = hasFireEffect ? textureLoader.Queue("./Resources/Textures/fireFX_diffuse.png") : nullptr;
+        auto* pShipMaps = textureLoader.QueueInterleaved(pShipDiffuse, pShipNormal, pShipGloss, pShipSpecular);
+        textureLoader.Load(pDevice);
+
+        auto* pMaterialManager = MaterialManager::GetInstance();
+        auto* pSceneGraph = SceneGraph::GetInstance();
+        pSceneGraph->AddScene(0);
+
+        const auto shipMaterial = pMaterialManager->AddMaterial(new MaterialMapped(pDevice, L"./Resources/Shaders/PosCol3D.fx", pShipDiffuse, pShipNormal, pShipGloss, pShipSpecular, 25.f, "ShipMat", false, pShipMaps));
+        pSceneGraph->AddObjectToGraph(new Mesh(pDevice, "./Resources/Meshes/vehicle.obj", shipMaterial, glm::vec3(0, 0, 0)), 0);
+        if (!hasFireEffect)
+            return;
+
+        const auto fireMaterial = pMaterialManager->AddMaterial(new MaterialFlat(pDevice, L"./Resources/Shaders/FlatTransparency.fx", pFireDiffuse, "FireMat", true));
+        pSceneGraph->AddObjectToGraph(new Mesh(pDevice, "./Resources/Meshes/fireFX.obj", fireMaterial, glm::vec3(0, 0, 0)), 0);
+    }
+}
+
+bool SceneLoader::Load(const std::string_view sceneName, ID3D11Device* pDevice)
+{
+    if (sceneName == "vehicle")
+        LoadVehicle(pDevice, true);
+    else if (sceneName == "vehicle_opaque")
+        LoadVehicle(pDevice, false);
+    else
+    {
+        LOG(LEVEL_ERROR, "Unknown scene " << sceneName)
+        return false;
+    }
+    return true;
+}
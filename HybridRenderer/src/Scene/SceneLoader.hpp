@@ -0,0 +1,19 @@
+#ifndef SCENE_LOADER_HPP
+#define SCENE_LOADER_HPP
+
+//Standard includes
+#include <array>
+#include <string_view>
+
+//Fills the scene graph and material manager, shared by the windowed and the headless renderer
+namespace SceneLoader
+{
+    //Scenes Load knows, the first one is what the renderers load by default
+    //"vehicle" is the ship with its blended fire effect, "vehicle_opaque" the ship on its own
+    constexpr std::array<std::string_view, 2> SceneNames{"vehicle", "vehicle_opaque"};
+
+    //Loads the named scene as scene 0, logs and returns false for an unknown name. The device may be null when there is no D3D backend
+    bool Load(std::string_view sceneName, ID3D11Device* pDevice);
+}
+
+#endif // !SCENE_LOADER_HPP
@@ -7,6 +7,7 @@
 #include <memory>
 
 //Project includes
+#include "Helpers/JobSystem.hpp"
 #include "Helpers/Timer.hpp"
 #pragma warning (push, 0)
 #include "ImGui/imgui_impl_sdl.h"
@@ -100,6 +101,7 @@ int main(int argc, char* argv[])
 	MaterialManager::GetInstance()->Destroy();
 	Logger::GetInstance()->Destroy();
 	SafeDelete(pRenderer);
+	JobSystem::GetInstance()->Destroy();
 	SafeDelete(pTimer);
 	ImGui::DestroyContext();
 	ShutDown(pWindow);
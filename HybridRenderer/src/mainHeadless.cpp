@@ -0,0 +1,239 @@
+#include "pch.h"
+
+//Standard includes
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+
+//Project includes
+#include "Debugging/Benchmark.hpp"
+#include "Debugging/Logger.hpp"
+#include "Helpers/GeometryHelpers.hpp"
+#include "Helpers/JobSystem.hpp"
+#include "Helpers/magic_enum.hpp"
+#include "Materials/MaterialManager.hpp"
+#include "Rendering/Camera.hpp"
+#include "Rendering/HeadlessRenderer.hpp"
+#include "Scene/SceneGraph.hpp"
+#include "Scene/SceneLoader.hpp"
+
+//Entry point of the headless build, renders a fixed number of frames with the software rasterizer and writes them to disk.
+//With --benchmark it plays a camera path instead and writes the frame time statistics as JSON, frames are then only saved when --output is given.
+//Resources are loaded relative to the working directory, run it from the directory that holds Resources.
+
+struct HeadlessSettings
+{
+	uint32_t frameCount = 1;
+	uint32_t width = 1920;
+	uint32_t height = 1080;
+	uint32_t threadCount = 0; // 0 = not given, hardware concurrency
+	uint32_t tileSize = 0;    // 0 = not given, scene graph default
+	bool areObjectsRotating = false;
+	bool hasFrameCount = false;
+	std::string sceneName{SceneLoader::SceneNames[0]};
+	std::string outputDirectory;
+	SoftwareShadingMode shadingMode = SoftwareShadingMode::Forward;
+	SoftwareAntiAliasing antiAliasing = SoftwareAntiAliasing::None;
+
+	//Benchmark mode
+	std::string benchmarkFile;
+	std::string pathName{"orbit"};
+	uint32_t warmupFrameCount = 10;
+};
+
+void PrintUsage()
+{
+	std::cerr << "Usage: HybridRendererHeadless [--frames N] [--width W] [--height H] [--threads T] [--tile-size S] [--rotate] [--output DIR]\n"
+		<< "                              [--scene NAME] [--shading Forward|VisibilityBuffer|DepthPrePass] [--msaa]\n"
+		<< "                              [--benchmark FILE.json] [--path NAME] [--warmup N]\n"
+		<< "Scenes:";
+	for (const auto name : SceneLoader::SceneNames)
+	{
+		std::cerr << " " << name;
+	}
+	std::cerr << "\nPaths:";
+	for (const auto name : CameraPath::PathNames)
+	{
+		std::cerr << " " << name;
+	}
+	std::cerr << "\n";
+}
+
+bool ParseArguments(const int argc, char* argv[], HeadlessSettings& settings)
+{
+	// Numbers have to be whole, no trailing characters and no silent fallback to a default
+	auto isValid = true;
+	const auto toUInt = [&isValid](const char* pOption, const char* pValue, const uint32_t minimum, const uint32_t maximum = std::numeric_limits<uint32_t>::max())
+	{
+		char* pEnd = nullptr;
+		const auto value = std::strtoul(pValue, &pEnd, 10);
+		if (pEnd == pValue || *pEnd != '\0' || *pValue == '-' || value < minimum || value > maximum)
+		{
+			std::cerr << "Invalid value for " << pOption << ": " << pValue << ", expected a whole number of at least " << minimum;
+			if (maximum != std::numeric_limits<uint32_t>::max())
+				std::cerr << " and at most " << maximum;
+			std::cerr << "\n";
+			isValid = false;
+			return minimum;
+		}
+		return static_cast<uint32_t>(value);
+	};
+
+	for (int i = 1; i < argc && isValid; ++i)
+	{
+		const auto* pOption = argv[i];
+		const auto hasValue = i + 1 < argc;
+		if (std::strcmp(pOption, "--rotate") == 0)
+			settings.areObjectsRotating = true;
+		else if (std::strcmp(pOption, "--msaa") == 0)
+			settings.antiAliasing = SoftwareAntiAliasing::MSAA4x;
+		else if (!hasValue)
+		{
+			std::cerr << "Unknown option or missing value: " << pOption << "\n";
+			return false;
+		}
+		else if (std::strcmp(pOption, "--frames") == 0)
+		{
+			settings.frameCount = toUInt(pOption, argv[++i], 1);
+			settings.hasFrameCount = true;
+		}
+		else if (std::strcmp(pOption, "--width") == 0)
+			settings.width = toUInt(pOption, argv[++i], 1, bgh::MaxViewportSize);
+		else if (std::strcmp(pOption, "--height") == 0)
+			settings.height = toUInt(pOption, argv[++i], 1, bgh::MaxViewportSize);
+		else if (std::strcmp(pOption, "--threads") == 0)
+			settings.threadCount = toUInt(pOption, argv[++i], 1);
+		else if (std::strcmp(pOption, "--tile-size") == 0)
+			settings.tileSize = toUInt(pOption, argv[++i], 1);
+		else if (std::strcmp(pOption, "--output") == 0)
+			settings.outputDirectory = argv[++i];
+		else if (std::strcmp(pOption, "--scene") == 0)
+			settings.sceneName = argv[++i];
+		else if (std::strcmp(pOption, "--benchmark") == 0)
+			settings.benchmarkFile = argv[++i];
+		else if (std::strcmp(pOption, "--path") == 0)
+			settings.pathName = argv[++i];
+		else if (std::strcmp(pOption, "--warmup") == 0)
+			settings.warmupFrameCount = toUInt(pOption, argv[++i], 0);
+		else if (std::strcmp(pOption, "--shading") == 0)
+		{
+			const auto shadingMode = magic_enum::enum_cast<SoftwareShadingMode>(argv[++i]);
+			if (!shadingMode.has_value())
+			{
+				std::cerr << "Unknown shading mode: " << argv[i] << "\n";
+				return false;
+			}
+			settings.shadingMode = shadingMode.value();
+		}
+		else
+		{
+			std::cerr << "Unknown option: " << pOption << "\n";
+			return false;
+		}
+	}
+	return isValid;
+}
+
+int RenderFrames(HeadlessRenderer& renderer, const HeadlessSettings& settings)
+{
+	auto* pSceneGraph = SceneGraph::GetInstance();
+	const auto outputDirectory = settings.outputDirectory.empty() ? std::string(".") : settings.outputDirectory;
+
+	// Every frame advances by the same step, so a run renders the same images no matter how long the frames take
+	const auto dT = 1.f / 60.f;
+	for (uint32_t frameIdx = 0; frameIdx < settings.frameCount; ++frameIdx)
+	{
+		//--------- Updates ---------
+		pSceneGraph->GetCamera()->Update(dT);
+		pSceneGraph->Update(dT);
+		//--------- Render ---------
+		renderer.Render();
+		Logger::GetInstance()->OutputLog();
+
+		char fileName[32];
+		std::snprintf(fileName, sizeof(fileName), "/frame_%04u.png", frameIdx);
+		if (!renderer.SaveFrame(outputDirectory + fileName))
+			return 1;
+	}
+	return 0;
+}
+
+int RunBenchmark(HeadlessRenderer& renderer, const HeadlessSettings& settings)
+{
+	BenchmarkSettings benchmarkSettings{};
+	benchmarkSettings.sceneName = settings.sceneName;
+	benchmarkSettings.pathName = settings.pathName;
+	benchmarkSettings.warmupFrameCount = settings.warmupFrameCount;
+	benchmarkSettings.frameDirectory = settings.outputDirectory;
+	if (settings.hasFrameCount)
+		benchmarkSettings.frameCount = settings.frameCount;
+
+	Benchmark benchmark{benchmarkSettings};
+	if (!benchmark.Run(renderer))
+		return 1;
+
+	if (settings.benchmarkFile == "-")
+	{
+		benchmark.WriteJSON(std::cout);
+		return 0;
+	}
+
+	std::ofstream file(settings.benchmarkFile);
+	if (!file)
+	{
+		LOG(LEVEL_ERROR, "Failed to open " << settings.benchmarkFile)
+		return 1;
+	}
+	benchmark.WriteJSON(file);
+	LOG(LEVEL_SUCCESS, "Benchmark results written to " << settings.benchmarkFile)
+	return 0;
+}
+
+int main(int argc, char* argv[])
+{
+	HeadlessSettings settings{};
+	if (!ParseArguments(argc, argv, settings))
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	// Frames are written as they're rendered, so a missing directory has to exist before the first one
+	if (!settings.outputDirectory.empty())
+	{
+		std::error_code error;
+		std::filesystem::create_directories(settings.outputDirectory, error);
+		if (error)
+		{
+			std::cerr << "Failed to create output directory " << settings.outputDirectory << ": " << error.message() << "\n";
+			return 1;
+		}
+	}
+
+	auto* pSceneGraph = SceneGraph::GetInstance();
+	if (settings.threadCount != 0)
+		pSceneGraph->SetThreadCount(settings.threadCount);
+	if (settings.tileSize != 0)
+		pSceneGraph->SetSoftwareTileSize(settings.tileSize);
+	pSceneGraph->SetObjectsRotating(settings.areObjectsRotating);
+	pSceneGraph->SetSoftwareShadingMode(settings.shadingMode);
+	pSceneGraph->SetSoftwareAntiAliasing(settings.antiAliasing);
+
+	auto* pRenderer = new HeadlessRenderer(settings.width, settings.height, settings.sceneName);
+	auto result = 1;
+	if (pRenderer->IsSceneLoaded())
+		result = settings.benchmarkFile.empty() ? RenderFrames(*pRenderer, settings) : RunBenchmark(*pRenderer, settings);
+	Logger::GetInstance()->OutputLog();
+
+	//Shutdown
+	SceneGraph::GetInstance()->Destroy();
+	MaterialManager::GetInstance()->Destroy();
+	SafeDelete(pRenderer);
+	Logger::GetInstance()->Destroy();
+	JobSystem::GetInstance()->Destroy();
+	return result;
+}
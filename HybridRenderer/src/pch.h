@@ -6,9 +6,14 @@
 #include <string>
 #include <string_view>
 #include <vector>
+#define GLM_FORCE_SILENT_WARNINGS
+
+#ifdef HYBRID_HEADLESS
+// Headless builds have no window, UI or device, the device types only exist as handles of the null backend
+#include "Rendering/NullGraphics.hpp"
+#else
 #define NOMINMAX  //for directx
 
-#define GLM_FORCE_SILENT_WARNINGS
 // SDL Headers
 #include <SDL.h>
 #include <SDL_syswm.h>
@@ -28,6 +33,7 @@
 #include <d3d11.h>
 #include <d3dcompiler.h>
 #include <d3dx11effect.h>
+#endif
 
 #include <glm/glm.hpp>
 
@@ -62,6 +68,13 @@ inline void SafeDelete(T* pObject)
     }
 }
 
+#ifdef HYBRID_HEADLESS
+// The null backend never creates a resource
+template <class T>
+inline void SafeRelease(T*)
+{
+}
+#else
 template <class T>
 inline void SafeRelease(T* pResource)
 {
@@ -70,4 +83,5 @@ inline void SafeRelease(T* pResource)
         pResource->Release();
         pResource = nullptr;
     }
-}
\ No newline at end of file
+}
+#endif
\ No newline at end of file